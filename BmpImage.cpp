@@ -1,7 +1,10 @@
 #include "BmpImage.h"
+#include "MappedFile.h"
 #include <fstream>
 #include <iostream>
 #include <cstring>
+#include <cstdio>
+#include <utility>
 
 /**
  * @file BmpImage.cpp
@@ -14,9 +17,131 @@
 
 using namespace std;
 
+/**
+ * @brief ļͷϢͷƵݴС
+ *
+ * ʹļͷеܴС㣬ѡϢͷеݴС
+ *
+ * @param[in] fileHeader ļͷ
+ * @param[in] infoHeader Ϣͷ
+ * @return ݴС(ֽ)޷ƵʱΪ0
+ */
+static size_t derivePixelSize(const BmpFileHeader& fileHeader, const BmpInfoHeader& infoHeader)
+{
+	size_t dataOffset = fileHeader.bfOffBits;
+	size_t pixelSize = 0;
+	if (fileHeader.bfSize > dataOffset) {
+		pixelSize = fileHeader.bfSize - dataOffset;
+	}
+	if (pixelSize == 0 && infoHeader.biSizeImage > 0) {
+		pixelSize = infoHeader.biSizeImage;
+	}
+	return pixelSize;
+}
+
+BmpImage::BmpImage() = default;
+BmpImage::~BmpImage() = default;
+
+BmpImage::BmpImage(const BmpImage& other)
+	: m_fileHeader(other.m_fileHeader),
+	m_infoHeader(other.m_infoHeader),
+	m_extraHeader(other.m_extraHeader),
+	m_pixelData(other.m_pixels, other.m_pixels + other.m_pixelSize),
+	m_sourcePath(other.m_sourcePath),
+	m_sourceStamp(other.m_sourceStamp),
+	m_dirty(other.m_dirty)
+{
+	m_pixels = m_pixelData.data();
+	m_pixelSize = m_pixelData.size();
+}
+
+BmpImage& BmpImage::operator=(const BmpImage& other)
+{
+	if (this != &other) {
+		BmpImage tmp(other);
+		*this = std::move(tmp);
+	}
+	return *this;
+}
+
+BmpImage::BmpImage(BmpImage&& other) noexcept
+	: m_fileHeader(other.m_fileHeader),
+	m_infoHeader(other.m_infoHeader),
+	m_extraHeader(std::move(other.m_extraHeader)),
+	m_pixelData(std::move(other.m_pixelData)),
+	m_mapping(std::move(other.m_mapping)),
+	m_pixels(other.m_pixels),
+	m_pixelSize(other.m_pixelSize),
+	m_readOnlyMapping(other.m_readOnlyMapping),
+	m_sourcePath(std::move(other.m_sourcePath)),
+	m_sourceStamp(other.m_sourceStamp),
+	m_dirty(std::move(other.m_dirty))
+{
+	other.m_pixels = nullptr;
+	other.m_pixelSize = 0;
+	other.m_readOnlyMapping = false;
+}
+
+BmpImage& BmpImage::operator=(BmpImage&& other) noexcept
+{
+	if (this != &other) {
+		m_fileHeader = other.m_fileHeader;
+		m_infoHeader = other.m_infoHeader;
+		m_extraHeader = std::move(other.m_extraHeader);
+		m_pixelData = std::move(other.m_pixelData);
+		m_mapping = std::move(other.m_mapping);
+		m_pixels = other.m_pixels;
+		m_pixelSize = other.m_pixelSize;
+		m_readOnlyMapping = other.m_readOnlyMapping;
+		m_sourcePath = std::move(other.m_sourcePath);
+		m_sourceStamp = other.m_sourceStamp;
+		m_dirty = std::move(other.m_dirty);
+		other.m_pixels = nullptr;
+		other.m_pixelSize = 0;
+		other.m_readOnlyMapping = false;
+	}
+	return *this;
+}
+
+/**
+ * @brief дʱƸ
+ *
+ * ӳ䷽ʽ¸ָָµ˽ӳͬƫƴ
+ * ֻӳģͬãӳΪд˽ӳ䣬ҪתΪڴ渱
+ *
+ * @param[out] clone 
+ * @return ɹtrueʧܷfalse
+ */
+bool BmpImage::cloneCopyOnWrite(BmpImage& clone) const
+{
+	if (!m_mapping) {
+		clone = *this;
+		return true;
+	}
+
+	unique_ptr<MappedFile> mapping(new MappedFile());
+	if (!mapping->openCopy(*m_mapping)) {
+		return false;
+	}
+
+	BmpImage copy;
+	copy.m_fileHeader = m_fileHeader;
+	copy.m_infoHeader = m_infoHeader;
+	copy.m_extraHeader = m_extraHeader;
+	copy.m_pixels = mapping->data() + (m_pixels - m_mapping->data());
+	copy.m_pixelSize = m_pixelSize;
+	copy.m_mapping = std::move(mapping);
+	copy.m_sourcePath = m_sourcePath;
+	copy.m_sourceStamp = m_sourceStamp;
+	copy.m_dirty = m_dirty;
+	clone = std::move(copy);
+	return true;
+}
+
 /**
  * @brief ļBMPͼ
  * @param[in] filename ҪصBMPļ·
+ * @param[in] mode طʽ
  * @return سɹtrueʧܷfalse
  *
  * ÷ִ²
@@ -28,8 +153,41 @@ using namespace std;
  * @note ļʧܻʽϸϢcerr
  * @warning ʧܻͼ
  */
-bool BmpImage::load(const std::string& filename)
+bool BmpImage::load(const std::string& filename, BmpLoadMode mode)
+{
+	// ͷ֮ǰӳ
+	m_mapping.reset();
+	m_pixelData.clear();
+	m_extraHeader.clear();
+	m_pixels = nullptr;
+	m_pixelSize = 0;
+	m_readOnlyMapping = false;
+	m_dirty.clear();
+
+	// ¼ԴжԴļǷʱһ
+	m_sourcePath.clear();
+	FileStamp stamp;
+	if (!fileStamp(filename, stamp)) {
+		cerr << "[] ޷ļ: " << filename << endl;
+		return false;
+	}
+
+	bool ok = (mode != BMP_LOAD_COPY) ? loadMapped(filename, mode) : loadCopy(filename);
+	if (ok) {
+		m_sourcePath = filename;
+		m_sourceStamp = stamp;
+	}
+	return ok;
+}
+
+/**
+ * @brief ڴ渱ʽ
+ * @param[in] filename ҪصBMPļ·
+ * @return سɹtrueʧܷfalse
+ */
+bool BmpImage::loadCopy(const std::string& filename)
 {
+
 	// Զģʽļ
 	ifstream fin(filename, ios::binary);
 	if (!fin.is_open()) {
@@ -78,15 +236,7 @@ bool BmpImage::load(const std::string& filename)
 	}
 
 	/* ݶȡ */
-	size_t pixelSize = 0;
-	// ʹļͷеܴС
-	if (m_fileHeader.bfSize > dataOffset) {
-		pixelSize = m_fileHeader.bfSize - dataOffset;
-	}
-	// ѡϢͷеݴС
-	if (pixelSize == 0 && m_infoHeader.biSizeImage > 0) {
-		pixelSize = m_infoHeader.biSizeImage;
-	}
+	size_t pixelSize = derivePixelSize(m_fileHeader, m_infoHeader);
 
 	m_pixelData.resize(pixelSize);
 	fin.seekg(dataOffset, ios::beg);
@@ -103,10 +253,228 @@ bool BmpImage::load(const std::string& filename)
 		}
 	}
 
+	m_pixels = m_pixelData.data();
+	m_pixelSize = m_pixelData.size();
 	fin.close();
 	return true;
 }
 
+/**
+ * @brief ȡпѰַƽͼ
+ * @return ƽͼ24/32λͼݲʱزõͼ
+ */
+BmpPlaneView BmpImage::getPlaneView() const
+{
+	return planeViewOf(m_infoHeader, m_pixelSize);
+}
+
+/**
+ * @brief Ϣͷƽͼ
+ *
+ * пȰBMP淶ȡ ((ȡλ+31)/32)4 ֽڣÿǰ ȡͨ ֽΪЧأ
+ * Ϊ䡣пȵЧֽʱͼΪһΡ
+ *
+ * @param[in] info Ϣͷ
+ * @param[in] pixelSize ݴС(ֽ)
+ * @return ƽͼ24/32λͼݲʱزõͼ
+ */
+BmpPlaneView BmpImage::planeViewOf(const BmpInfoHeader& info, size_t pixelSize)
+{
+	BmpPlaneView view;
+	int bpp = info.biBitCount;
+	if ((bpp != 24 && bpp != 32) || info.biWidth <= 0 || info.biHeight == 0) {
+		return view;
+	}
+
+	size_t width = static_cast<size_t>(info.biWidth);
+	size_t rows = (info.biHeight > 0)
+		? static_cast<size_t>(info.biHeight)
+		: static_cast<size_t>(-static_cast<int64_t>(info.biHeight));
+	size_t stride = ((width * bpp + 31) / 32) * 4;
+	size_t rowBytes = width * (bpp / 8);
+
+	// ȫ(һпʡ)
+	if (rows > (pixelSize + (stride - rowBytes)) / stride) {
+		return view;
+	}
+
+	view.width = static_cast<int>(width);
+	view.rows = static_cast<int>(rows);
+	view.channels = bpp / 8;
+	view.rowStride = stride;
+	view.rowBytes = rowBytes;
+	if (stride == rowBytes) {
+		view.runs.push_back({ 0, rowBytes * rows });
+	}
+	else {
+		view.runs.reserve(rows);
+		for (size_t r = 0; r < rows; ++r) {
+			view.runs.push_back({ r * stride, rowBytes });
+		}
+	}
+	return view;
+}
+
+/**
+ * @brief ļӳ䷽ʽBMPͼ
+ * @param[in] filename ҪصBMPļ·
+ * @param[in] mode ӳ䷽ʽ(ֻ/˽/)
+ * @return سɹtrueʧܷfalse
+ *
+ * ļͷϢͷֱӴӳָָӳڵʼλã
+ * ظơشСƵڴ渱ʽһ£
+ * У䲻ļʵʴС
+ */
+bool BmpImage::loadMapped(const std::string& filename, BmpLoadMode mode)
+{
+	MapAccess access = MAP_ACCESS_READONLY;
+	if (mode == BMP_MAP_PRIVATE) access = MAP_ACCESS_PRIVATE;
+	if (mode == BMP_MAP_SHARED) access = MAP_ACCESS_SHARED;
+
+	unique_ptr<MappedFile> mapping(new MappedFile());
+	if (!mapping->open(filename, access)) {
+		return false;
+	}
+
+	const unsigned char* base = mapping->data();
+	size_t fileSize = mapping->size();
+
+	/* ļͷϢͷԭؽ */
+	if (fileSize < sizeof(BmpFileHeader) + sizeof(BmpInfoHeader)) {
+		cerr << "[] ЧBMPļ: " << filename << " (ļС)" << endl;
+		return false;
+	}
+	memcpy(&m_fileHeader, base, sizeof(m_fileHeader));
+	if (m_fileHeader.bfType != 0x4D42) {
+		cerr << "[] ЧBMPļ: " << filename
+			<< " (ļͱʶӦΪ0x4D42)" << endl;
+		return false;
+	}
+	memcpy(&m_infoHeader, base + sizeof(m_fileHeader), sizeof(m_infoHeader));
+
+	/* չͷ/ɫ */
+	size_t dataOffset = m_fileHeader.bfOffBits;
+	size_t curPos = sizeof(BmpFileHeader) + sizeof(BmpInfoHeader);
+	if (dataOffset > fileSize) {
+		cerr << "[] ƫƳļΧ: " << filename << endl;
+		return false;
+	}
+	if (dataOffset > curPos) {
+		m_extraHeader.assign(base + curPos, base + dataOffset);
+	}
+
+	/* ݶλ */
+	size_t pixelSize = derivePixelSize(m_fileHeader, m_infoHeader);
+	if (pixelSize > fileSize - dataOffset) {
+		cerr << "[] ȡʧ: " << filename
+			<< " (С: " << pixelSize
+			<< ", ʵʿ: " << (fileSize - dataOffset) << ")" << endl;
+		return false;
+	}
+
+	m_mapping = std::move(mapping);
+	m_pixels = m_mapping->data() + dataOffset;
+	m_pixelSize = pixelSize;
+	m_readOnlyMapping = (mode == BMP_MAP_READONLY);
+	return true;
+}
+
+/**
+ * @brief ֻȡļͷϢͷ
+ *
+ * Уӳ䷽ʽһ£ļͷͱʶΪ0x4D42
+ * ƫƵݴСļʵʴС
+ *
+ * @param[in] file Ѵ򿪵ļ
+ * @param[in] filename ļ·(ڴϢ)
+ * @param[out] headers ͷϢ
+ * @return ɹtrueʧܷfalse
+ */
+bool BmpImage::readHeaders(const PositionalFile& file, const std::string& filename, BmpHeaders& headers)
+{
+	size_t fileSize = file.size();
+	unsigned char raw[sizeof(BmpFileHeader) + sizeof(BmpInfoHeader)];
+	if (fileSize < sizeof(raw) || !file.readAt(0, raw, sizeof(raw))) {
+		cerr << "[] ЧBMPļ: " << filename << " (ļС)" << endl;
+		return false;
+	}
+	memcpy(&headers.fileHeader, raw, sizeof(BmpFileHeader));
+	memcpy(&headers.infoHeader, raw + sizeof(BmpFileHeader), sizeof(BmpInfoHeader));
+	if (headers.fileHeader.bfType != 0x4D42) {
+		cerr << "[] ЧBMPļ: " << filename
+			<< " (ļͱʶӦΪ0x4D42)" << endl;
+		return false;
+	}
+
+	size_t dataOffset = headers.fileHeader.bfOffBits;
+	if (dataOffset > fileSize) {
+		cerr << "[] ƫƳļΧ: " << filename << endl;
+		return false;
+	}
+	size_t pixelSize = derivePixelSize(headers.fileHeader, headers.infoHeader);
+	if (pixelSize > fileSize - dataOffset) {
+		cerr << "[] ȡʧ: " << filename
+			<< " (С: " << pixelSize
+			<< ", ʵʿ: " << (fileSize - dataOffset) << ")" << endl;
+		return false;
+	}
+
+	headers.pixelOffset = dataOffset;
+	headers.pixelSize = pixelSize;
+	return true;
+}
+
+/**
+ * @brief ӳеظƵڴ渱ӳ
+ *
+ * ֻӳͼ״дָʱãдֻҳ档
+ */
+void BmpImage::detachMapping()
+{
+	if (!m_mapping) return;
+	m_pixelData.assign(m_pixels, m_pixels + m_pixelSize);
+	m_mapping.reset();
+	m_pixels = m_pixelData.data();
+	m_readOnlyMapping = false;
+}
+
+/**
+ * @brief ǼԼԴ޸ĵֽڷΧ
+ *
+ * ·ΧཻڵзΧϲΪһΣַΧƫ
+ *
+ * @param[in] offset ƫ(ֽ)
+ * @param[in] length (ֽ)
+ */
+void BmpImage::markDirty(size_t offset, size_t length)
+{
+	if (offset >= m_pixelSize || length == 0) return;
+	size_t end = offset + min(length, m_pixelSize - offset);
+
+	vector<BmpByteRun> merged;
+	merged.reserve(m_dirty.size() + 1);
+	bool placed = false;
+	for (const BmpByteRun& run : m_dirty) {
+		size_t runEnd = run.offset + run.length;
+		if (runEnd < offset) {
+			merged.push_back(run);
+		}
+		else if (run.offset > end) {
+			if (!placed) {
+				merged.push_back(BmpByteRun{ offset, end - offset });
+				placed = true;
+			}
+			merged.push_back(run);
+		}
+		else {
+			offset = min(offset, run.offset);
+			end = max(end, runEnd);
+		}
+	}
+	if (!placed) merged.push_back(BmpByteRun{ offset, end - offset });
+	m_dirty.swap(merged);
+}
+
 /**
  * @brief ͼ񱣴ΪBMPļ
  * @param[in] filename ļ·
@@ -118,10 +486,104 @@ bool BmpImage::load(const std::string& filename)
  * 3. дչͷɫ
  * 4. д
  *
+ * ܹȷļԴֻѵǼǵ޸ķΧʱ(writeDirty)ֻдͷЩΧ
+ *
  * @note ʧܻϸϢcerr
  * @warning ḲѴڵͬļ
  */
 bool BmpImage::save(const std::string& filename) const
+{
+	if (m_mapping && m_mapping->refersTo(filename)) {
+		if (m_mapping->access() == MAP_ACCESS_SHARED) {
+			// ӳԭر棺ӳ޸ģдļͷͬ޸ĵķΧ
+			BmpFileHeader fh = m_fileHeader;
+			fh.bfSize = static_cast<uint32_t>(m_fileHeader.bfOffBits + m_pixelSize);
+			unsigned char* base = m_mapping->data();
+			memcpy(base, &fh, sizeof(fh));
+			memcpy(base + sizeof(fh), &m_infoHeader, sizeof(m_infoHeader));
+			size_t pixelOffset = static_cast<size_t>(m_pixels - base);
+			bool ok = m_mapping->flush(0, sizeof(fh) + sizeof(m_infoHeader));
+			for (const BmpByteRun& run : m_dirty) {
+				ok = ok && m_mapping->flush(pixelOffset + run.offset, run.length);
+			}
+			if (!ok) {
+				cerr << "[] ͬӳʧ: " << filename << endl;
+				return false;
+			}
+			return true;
+		}
+
+		// ˽ӳΪԴļֻд޸ĵķΧضļӳӰ
+		if (writeDirty(filename)) return true;
+
+		// ΪӳԴļضдƻӳдʱļ滻
+		string tmpName = filename + ".tmp";
+		if (!writeFile(tmpName)) {
+			remove(tmpName.c_str());
+			return false;
+		}
+#ifdef _WIN32
+		remove(filename.c_str());
+#endif
+		if (rename(tmpName.c_str(), filename.c_str()) != 0) {
+			cerr << "[] 滻Դļʧ: " << filename << endl;
+			return false;
+		}
+		return true;
+	}
+
+	if (writeDirty(filename)) return true;
+	return writeFile(filename);
+}
+
+/**
+ * @brief Դļreflinkֻдͷ뱻޸ĵķΧ
+ *
+ * ҪͼļءغԴļĴС޸ʱδ䡢޸ķΧݣ
+ * ΪԴļԴļreflinkõ(reflinkFile)
+ * ʱдļͷϢͷ޸ķΧļضϵͷݵܳȣ
+ * writeFileдļͬ
+ *
+ * @param[in] filename ļ·
+ * @return дtrueдʧܷfalseɵд
+ */
+bool BmpImage::writeDirty(const std::string& filename) const
+{
+	if (m_sourcePath.empty() || !m_pixels) return false;
+	if (m_dirty.size() == 1 && m_dirty[0].offset == 0 && m_dirty[0].length == m_pixelSize) return false;
+	if (m_infoHeader.biSize < sizeof(BmpInfoHeader) ||
+		m_fileHeader.bfOffBits < sizeof(BmpFileHeader) + sizeof(BmpInfoHeader)) {
+		return false;
+	}
+
+	FileStamp stamp;
+	if (!fileStamp(m_sourcePath, stamp) || stamp != m_sourceStamp) return false;
+	if (!sameFile(filename, m_sourcePath) && !reflinkFile(m_sourcePath, filename)) return false;
+
+	PositionalFile out;
+	if (!out.open(filename, true)) return false;
+
+	BmpFileHeader fh = m_fileHeader;
+	size_t offBits = fh.bfOffBits;
+	fh.bfSize = static_cast<uint32_t>(offBits + m_pixelSize);
+	bool ok = out.writeAt(0, &fh, sizeof(fh)) &&
+		out.writeAt(sizeof(fh), &m_infoHeader, sizeof(m_infoHeader));
+	for (const BmpByteRun& run : m_dirty) {
+		ok = ok && out.writeAt(offBits + run.offset, m_pixels + run.offset, run.length);
+	}
+	if (ok && out.size() > offBits + m_pixelSize) ok = out.resize(offBits + m_pixelSize);
+	if (!ok) {
+		cerr << "[] дʧܣΪд: " << filename << endl;
+	}
+	return ok;
+}
+
+/**
+ * @brief ʽдBMPļ
+ * @param[in] filename ļ·
+ * @return ɹtrueʧܷfalse
+ */
+bool BmpImage::writeFile(const std::string& filename) const
 {
 	// Զģʽ/ضļ
 	ofstream fout(filename, ios::binary | ios::trunc);
@@ -134,7 +596,7 @@ bool BmpImage::save(const std::string& filename) const
 	BmpFileHeader fh = m_fileHeader;
 	BmpInfoHeader ih = m_infoHeader;
 	uint32_t offBits = fh.bfOffBits;
-	uint32_t pixelSize = static_cast<uint32_t>(m_pixelData.size());
+	uint32_t pixelSize = static_cast<uint32_t>(m_pixelSize);
 
 	// ļܴС
 	fh.bfSize = offBits + pixelSize;
@@ -197,11 +659,11 @@ bool BmpImage::save(const std::string& filename) const
 
 	/* д */
 	fout.seekp(offBits, ios::beg);
-	if (!m_pixelData.empty()) {
-		fout.write(reinterpret_cast<const char*>(m_pixelData.data()), m_pixelData.size());
+	if (m_pixelSize > 0) {
+		fout.write(reinterpret_cast<const char*>(m_pixels), m_pixelSize);
 		if (!fout) {
 			cerr << "[] дʧ (С: "
-				<< m_pixelData.size() << " ֽ)" << endl;
+				<< m_pixelSize << " ֽ)" << endl;
 			fout.close();
 			return false;
 		}
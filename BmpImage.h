@@ -3,8 +3,13 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <cstddef>
 #include <cstdint>
+#include "FileSystem.h"
+
+class MappedFile;
+class PositionalFile;
 
 /**
  * @file BmpImage.h
@@ -53,6 +58,69 @@ struct BmpInfoHeader {
 };
 #pragma pack(pop)
 
+/**
+ * @struct BmpByteRun
+ * @brief һЧֽ
+ */
+struct BmpByteRun {
+	size_t offset; ///< ƫ(ֽ)
+	size_t length; ///< (ֽ)Ϊÿֽ
+};
+
+/**
+ * @struct BmpPlaneView
+ * @brief пѰַƽͼ
+ *
+ * ϢͷеĿȡ߶λ㣬ųÿĩβ4ֽڶ䡣
+ * ÿЧֽڶر߽翪ʼڵiֽڵͨΪ i % channels
+ * ʱкϲΪһΡ
+ */
+struct BmpPlaneView {
+	int    width = 0;               ///< ͼ()
+	int    rows = 0;                ///< (߶ȵľֵ)
+	int    channels = 0;            ///< ÿֽ(34)
+	size_t rowStride = 0;           ///< п(ֽڣ)
+	size_t rowBytes = 0;            ///< ÿЧֽ
+	std::vector<BmpByteRun> runs;   ///< 洢˳еЧֽڶ
+
+	/**
+	 * @brief ͼǷ
+	 * @return ͼʽ֧ʱtrue
+	 */
+	bool valid() const { return !runs.empty(); }
+
+	/**
+	 * @brief ȡ
+	 * @return ȡ
+	 */
+	size_t pixelCount() const { return static_cast<size_t>(width) * static_cast<size_t>(rows); }
+};
+
+/**
+ * @struct BmpHeaders
+ * @brief ȡļͷϢͷɵõͼϢ
+ */
+struct BmpHeaders {
+	BmpFileHeader fileHeader{}; ///< ļͷ
+	BmpInfoHeader infoHeader{}; ///< Ϣͷ
+	size_t pixelOffset = 0;     ///< ļеƫ(ֽ)
+	size_t pixelSize = 0;       ///< ݴС(ֽ)ƵBmpImage::loadһ
+};
+
+/**
+ * @enum BmpLoadMode
+ * @brief BMPͼطʽ
+ *
+ * ӳ䷽ʽֱָļӳ帴Ƶڴ棬
+ * ֻд㷨ʵʷʵҳŻᱻ롣
+ */
+enum BmpLoadMode {
+	BMP_LOAD_COPY = 0,    ///< ڴ渱(Ĭ)ļȫ
+	BMP_MAP_READONLY = 1, ///< ֻӳ䣬ȡ״λȡдָʱתΪڴ渱
+	BMP_MAP_PRIVATE = 2,  ///< ˽дʱӳ䣬غ棻޸ĵҳ
+	BMP_MAP_SHARED = 3    ///< дӳ䣬޸ֱдԴļԭ
+};
+
 /**
  * @class BmpImage
  * @brief BMPͼ
@@ -62,24 +130,54 @@ struct BmpInfoHeader {
  */
 class BmpImage {
 public:
+	BmpImage();
+	~BmpImage();
+
+	/**
+	 * @brief ƹ
+	 * @note ӳ䷽ʽصͼƺΪڴ渱
+	 */
+	BmpImage(const BmpImage& other);
+	BmpImage& operator=(const BmpImage& other);
+	BmpImage(BmpImage&& other) noexcept;
+	BmpImage& operator=(BmpImage&& other) noexcept;
+
+	/**
+	 * @brief дʱƸ
+	 * @param[out] clone ԭݱ滻
+	 * @return ɹtrueʧܷfalse
+	 * @note ӳ䷽ʽصͼͬһļٽһ˽ӳ䣬ֻб޸ĵҳ
+	 *       뱾󻥲Ӱ죻ڴ渱ʽصͼ帴
+	 */
+	bool cloneCopyOnWrite(BmpImage& clone) const;
+
 	/**
 	 * @brief ļBMPͼ
 	 * @param[in] filename ҪصBMPļ·
+	 * @param[in] mode طʽĬ϶ڴ渱
 	 * @return سɹtrueʧܷfalse
 	 * @exception 쳣׳ô״̬
 	 * @note ֧δѹ24/32λBMPʽ߶ֵΪϴ洢ʽ
 	 */
-	bool load(const std::string& filename);
+	bool load(const std::string& filename, BmpLoadMode mode = BMP_LOAD_COPY);
 
 	/**
 	 * @brief ͼ񱣴ΪBMPļ
 	 * @param[in] filename ļ·
 	 * @return ɹtrueʧܷfalse
 	 * @exception 쳣׳ô״̬
-	 * @note ļδѹʽԶض
+	 * @note ļδѹʽԶض룻
+	 *       ӳԴļʱдļͷͬ޸ĵķΧ
+	 *       ԴļԼغδ仯ԴļԴļreflinkõʱֻдͷ뱻޸ĵķΧ
 	 */
 	bool save(const std::string& filename) const;
 
+	/**
+	 * @brief Ƿļӳ䷽ʽ
+	 * @return ָӳʱtrue
+	 */
+	bool isMapped() const { return m_mapping != nullptr; }
+
 	/**
 	 * @brief ȡͼ
 	 * @return ͼȣأ
@@ -104,19 +202,75 @@ public:
 	 * @return ָݵĿдָ
 	 * @warning ֱ޸ݿƻͼ
 	 */
-	unsigned char* getPixelData() { return m_pixelData.data(); }
+	unsigned char* getPixelData() {
+		unsigned char* pixels = getWritablePixels();
+		markDirty(0, m_pixelSize);
+		return pixels;
+	}
+
+	/**
+	 * @brief ȡдָ룬Ǽ޸ķΧ
+	 * @return ָݵĿдָ
+	 * @warning markDirtyǼʵ޸ĵֽڣ©޸
+	 */
+	unsigned char* getWritablePixels() {
+		if (m_mapping && m_readOnlyMapping) detachMapping();
+		return m_pixels;
+	}
+
+	/**
+	 * @brief ǼԼԴ޸ĵֽڷΧ
+	 * @param[in] offset ƫ(ֽ)
+	 * @param[in] length (ֽ)ݵĲֱȥ
+	 * @note ѵǼǵķΧϲ̰߳ȫ
+	 */
+	void markDirty(size_t offset, size_t length);
+
+	/**
+	 * @brief ȡѵǼǵ޸ķΧ
+	 * @return ƫ򡢻صһڵķΧ
+	 */
+	const std::vector<BmpByteRun>& dirtyRanges() const { return m_dirty; }
+
+	/**
+	 * @brief ѵǼǵ޸ķΧ
+	 */
+	void clearDirty() { m_dirty.clear(); }
 
 	/**
 	 * @brief ȡָֻ
 	 * @return ָݵָֻ
 	 */
-	const unsigned char* getPixelData() const { return m_pixelData.data(); }
+	const unsigned char* getPixelData() const { return m_pixels; }
 
 	/**
 	 * @brief ȡݴС
 	 * @return ռõֽ
 	 */
-	size_t getPixelDataSize() const { return m_pixelData.size(); }
+	size_t getPixelDataSize() const { return m_pixelSize; }
+
+	/**
+	 * @brief ȡпѰַƽͼ
+	 * @return ƽͼ24/32λͼݲʱزõͼ
+	 */
+	BmpPlaneView getPlaneView() const;
+
+	/**
+	 * @brief Ϣͷƽͼ
+	 * @param[in] info Ϣͷ
+	 * @param[in] pixelSize ݴС(ֽ)
+	 * @return ƽͼ24/32λͼݲʱزõͼ
+	 */
+	static BmpPlaneView planeViewOf(const BmpInfoHeader& info, size_t pixelSize);
+
+	/**
+	 * @brief ֻȡļͷϢͷȡ
+	 * @param[in] file Ѵ򿪵ļ
+	 * @param[in] filename ļ·(ڴϢ)
+	 * @param[out] headers ͷϢ
+	 * @return ͷЧδļΧʱtrue
+	 */
+	static bool readHeaders(const PositionalFile& file, const std::string& filename, BmpHeaders& headers);
 
 	/**
 	 * @brief ȡƫ
@@ -129,7 +283,7 @@ public:
 	 * @return ͷݵļܴСֽڣ
 	 */
 	size_t getEstimatedFileSize() const {
-		return static_cast<size_t>(m_fileHeader.bfOffBits) + m_pixelData.size();
+		return static_cast<size_t>(m_fileHeader.bfOffBits) + m_pixelSize;
 	}
 
 	/**
@@ -146,11 +300,49 @@ public:
 	 */
 	BmpInfoHeader& infoHeader() { return m_infoHeader; }
 
+	/**
+	 * @brief ȡϢͷֻ
+	 * @return BMPϢͷֻ
+	 */
+	const BmpInfoHeader& infoHeader() const { return m_infoHeader; }
+
 private:
+	/**
+	 * @brief Զڴ渱ʽ
+	 */
+	bool loadCopy(const std::string& filename);
+
+	/**
+	 * @brief ļӳ䷽ʽأļͷӳԭؽ
+	 */
+	bool loadMapped(const std::string& filename, BmpLoadMode mode);
+
+	/**
+	 * @brief ӳеظƵڴ渱ӳ
+	 */
+	void detachMapping();
+
+	/**
+	 * @brief ʽдBMPļ
+	 */
+	bool writeFile(const std::string& filename) const;
+
+	/**
+	 * @brief Դļreflinkֻдͷ뱻޸ĵķΧ
+	 */
+	bool writeDirty(const std::string& filename) const;
+
 	BmpFileHeader m_fileHeader{};             ///< BMPļͷṹʵ
 	BmpInfoHeader m_infoHeader{};             ///< BMPϢͷṹʵ
 	std::vector<unsigned char> m_extraHeader; ///< չͷɫݣУ
-	std::vector<unsigned char> m_pixelData;   ///< ݴ洢
+	std::vector<unsigned char> m_pixelData;   ///< ݴ洢(ڴ渱ʽ)
+	std::unique_ptr<MappedFile> m_mapping;    ///< ļӳ(ӳ䷽ʽ)
+	unsigned char* m_pixels = nullptr;        ///< ǰʼַ
+	size_t m_pixelSize = 0;                   ///< ǰݴС(ֽ)
+	bool m_readOnlyMapping = false;           ///< ӳǷΪֻ
+	std::string m_sourcePath;                 ///< Դļ·
+	FileStamp m_sourceStamp;                  ///< ʱԴļĴС޸ʱ
+	std::vector<BmpByteRun> m_dirty;          ///< ԼԴ޸ĵֽڷΧ
 };
 
 #endif // BMP_IMAGE_H
\ No newline at end of file
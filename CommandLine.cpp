@@ -0,0 +1,1174 @@
+#include "CommandLine.h"
+#include "BmpImage.h"
+#include "StegoCore.h"
+#include "FileSystem.h"
+#include "CoverCache.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <iterator>
+
+/**
+ * @file CommandLine.cpp
+ * @brief ǽʽʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ÷
+ *   StegoTool hide     -i .bmp -d ļ -o .bmp [ѡ]
+ *   StegoTool hide     --manifest 嵥.tsv [ѡ]
+ *   StegoTool extract  -i д.bmp -o ļ [ѡ]
+ *   StegoTool extract  --manifest 嵥.tsv [ѡ]
+ *   StegoTool probe    [ѡ] ļĿ¼...
+ *   StegoTool capacity [ѡ] ļĿ¼...
+ *   StegoTool split    -d ļ -o Ŀ¼ [ѡ] Ŀ¼...
+ *   StegoTool join     -o ļ [ѡ] ͼĿ¼...
+ *   StegoTool append   -i ͼ.bmp -d ļ [-o .bmp] [ѡ]
+ *   StegoTool update   -i ͼ.bmp --index N -d ļ [-o .bmp] [ѡ]
+ *   StegoTool segments -i ͼ.bmp [--index N -o ļ] [ѡ]
+ *   StegoTool pack     -i .bmp -o .bmp [ѡ] Աļ...
+ *   StegoTool members  -i ͼ.bmp [--name  -o ļ] [ѡ]
+ *   StegoTool verify   [ѡ] ļĿ¼...
+ *
+ * 嵥ΪƱָıÿһ塢ļģʽͨ롢룬
+ * пʡԻ"-"ʹѡеֵextractļС
+ * #ͷбԣеһΪ"cover"ʱΪͷ
+ *
+ * hide徭CoverCacheأ嵥жʹͬһʱֻһļ
+ * ȡдʱƸֻƱ޸ĵҳ档
+ * ڹ̶Ĺִ߳УÿʼǰڴռôԤȡȣ
+ * Ԥ㲻ʱȴʹͬʱޡ
+ * д׼д׼󣬱ض
+ *
+ * splitһݷƬص(˳)ͼͬдĿ¼
+ * joinӸͼռͬһƬ顣ߵĲжΪ-tָ߳Ĭͬ-j
+ *
+ * append/updateֶθʽ׷ӷֶλ滻ֶΣδ-oʱԭ޸ͼֻдر仯ֽڣ
+ * segmentsгֶαȡֶΡ
+ *
+ * packļ(ļΪԱ)ΪصУmembersгԱ
+ * ֻȡָԱȡļ
+ *
+ * hide/split--chunkʱдУֵverifyУļȫݣ
+ * г𻵵ֽڷΧ(ֿݾȷ)
+ */
+
+using namespace std;
+
+/**
+ * @struct CliOptions
+ * @brief ѡ
+ */
+struct CliOptions {
+	StegoContext ctx;                   ///< ид嵥δָʹô˴ֵ
+	bool         modeSet = false;       ///< Ƿʽָģʽ(Զ)
+	bool         threadsSet = false;    ///< Ƿʽָÿ߳
+	size_t       workers = 0;           ///< ͬʱִе0ʾӲ߳
+	size_t       memoryLimit = 512u * 1024u * 1024u; ///< ͬʱִеڴ(ֽ)
+	string       manifest;              ///< 嵥ļ·
+	string       input;                 ///< дͼ
+	string       data;                  ///< 񣺴صļ
+	string       output;                ///< ļ
+	vector<string> paths;               ///< probe/capacityļĿ¼
+	size_t       index = 0;             ///< update/segmentsķֶ
+	bool         indexSet = false;      ///< Ƿ˷ֶ
+	size_t       maxSegments = StegoCore::kDefaultMaxSegments; ///< append½ֶʱķֶ
+	string       name;                  ///< membersȡĳԱ
+};
+
+/**
+ * @struct CliJob
+ * @brief һػȡ
+ */
+struct CliJob {
+	string       cover;   ///< (hide)дͼ(extract)
+	string       payload; ///< صļ(hide)
+	string       output;  ///< ļ
+	StegoContext ctx;     ///< д
+};
+
+/**
+ * @class MemoryBudget
+ * @brief ֽڼڴ
+ *
+ * ȡʱռϱ󳬹ȴûռöʱ
+ * ˵޵Ҳִ(ռȫ)
+ */
+class MemoryBudget {
+public:
+	explicit MemoryBudget(size_t limit) : m_limit(limit) {}
+
+	void acquire(size_t bytes) {
+		unique_lock<mutex> lock(m_mutex);
+		m_cv.wait(lock, [&] { return m_used == 0 || m_used + bytes <= m_limit; });
+		m_used += bytes;
+	}
+
+	void release(size_t bytes) {
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_used -= bytes;
+		}
+		m_cv.notify_all();
+	}
+
+private:
+	size_t             m_limit;
+	size_t             m_used = 0;
+	mutex              m_mutex;
+	condition_variable m_cv;
+};
+
+/**
+ * @brief ӡ÷
+ */
+static void printUsage() {
+	cerr << "÷:\n"
+		<< "  StegoTool hide     -i .bmp -d ļ -o .bmp [ѡ]\n"
+		<< "  StegoTool hide     --manifest 嵥.tsv [ѡ]\n"
+		<< "  StegoTool extract  -i д.bmp -o ļ [ѡ]\n"
+		<< "  StegoTool extract  --manifest 嵥.tsv [ѡ]\n"
+		<< "  StegoTool probe    [ѡ] ļĿ¼...\n"
+		<< "  StegoTool capacity [ѡ] ļĿ¼...\n"
+		<< "  StegoTool split    -d ļ -o Ŀ¼ [ѡ] Ŀ¼...\n"
+		<< "  StegoTool join     -o ļ [ѡ] ͼĿ¼...\n"
+		<< "  StegoTool append   -i ͼ.bmp -d ļ [-o .bmp] [ѡ]\n"
+		<< "  StegoTool update   -i ͼ.bmp --index N -d ļ [-o .bmp] [ѡ]\n"
+		<< "  StegoTool segments -i ͼ.bmp [--index N -o ļ] [ѡ]\n"
+		<< "  StegoTool pack     -i .bmp -o .bmp [ѡ] Աļ...\n"
+		<< "  StegoTool members  -i ͼ.bmp [--name  -o ļ] [ѡ]\n"
+		<< "  StegoTool verify   [ѡ] ļĿ¼...\n"
+		<< "ѡ:\n"
+		<< "  -m, --mode MODE       seq | random | enhanced | lazy | auto(ȡ/)0-3\n"
+		<< "  -c, --mask MASK       ͨ1-7(B=1,G=2,R=4)д0x07\n"
+		<< "  -p, --password PW     \n"
+		<< "  -a, --auto            Զģʽͨ(ͬ -m auto)\n"
+		<< "      --layout L        rows | legacy˳/ǿģʽ岼\n"
+		<< "      --checksum C      crc32 | crc32c | legacyʱʹõУ㷨\n"
+		<< "      --chunk KB        ʱKBǧֽڷֿдУֵȡʱɶλ𻵵Ŀ飻ĬУ\n"
+		<< "  -j, --jobs N          ͬʱִеĬϰCPU\n"
+		<< "  -t, --threads N       ÿ߳ĬϲʱΪ1\n"
+		<< "      --memory MB       ͬʱִĹڴޣĬ512\n"
+		<< "      --manifest FILE   嵥(Ʊָ   [ģʽ [ []]])\n"
+		<< "  -i, --input FILE      дͼ\n"
+		<< "  -d, --data FILE       صļ\n"
+		<< "  -o, --output FILE     ļ\n"
+		<< "      --index N         ֶ(update/segments)\n"
+		<< "      --segments N      append½ֶʱķֶޣĬ64\n"
+		<< "      --name NAME       ҪȡԱ(members)\n";
+}
+
+/**
+ * @brief ȡдģʽ
+ * @param[in] mode дģʽ
+ * @return 
+ */
+static const char* modeKey(SteganoMode mode) {
+	switch (mode) {
+	case LSB_SEQUENTIAL:  return "seq";
+	case LSB_RANDOM:      return "random";
+	case LSB_ENHANCED:    return "enhanced";
+	case LSB_RANDOM_LAZY: return "lazy";
+	default:              return "unknown";
+	}
+}
+
+/**
+ * @brief дģʽ
+ * @param[in] text ģʽƻֵ
+ * @param[in,out] ctx дģ"auto"ʱautoDetectmodeautoDetect
+ * @return ɹtrue
+ */
+static bool parseMode(const string& text, StegoContext& ctx) {
+	if (text == "auto") { ctx.autoDetect = true; return true; }
+	SteganoMode mode;
+	if (text == "seq" || text == "sequential" || text == "0") mode = LSB_SEQUENTIAL;
+	else if (text == "random" || text == "1") mode = LSB_RANDOM;
+	else if (text == "enhanced" || text == "2") mode = LSB_ENHANCED;
+	else if (text == "lazy" || text == "3") mode = LSB_RANDOM_LAZY;
+	else return false;
+	ctx.mode = mode;
+	ctx.autoDetect = false;
+	return true;
+}
+
+/**
+ * @brief ͨ
+ * @param[in] text ʮƻ0xͷʮ
+ * @param[out] mask ͨ
+ * @return ȡֵΪ1-7ʱtrue
+ */
+static bool parseMask(const string& text, uint16_t& mask) {
+	char* end = nullptr;
+	unsigned long value = strtoul(text.c_str(), &end, 0);
+	if (text.empty() || *end != '\0' || value < 1 || value > 7) return false;
+	mask = static_cast<uint16_t>(value);
+	return true;
+}
+
+/**
+ * @brief Ǹ
+ * @param[in] text ʮı
+ * @param[out] value ֵ
+ * @return ɹtrue
+ */
+static bool parseCount(const string& text, size_t& value) {
+	char* end = nullptr;
+	unsigned long long v = strtoull(text.c_str(), &end, 10);
+	if (text.empty() || *end != '\0') return false;
+	value = static_cast<size_t>(v);
+	return true;
+}
+
+/**
+ * @brief ֮ѡ
+ * @param[in] argc 
+ * @param[in] argv б
+ * @param[out] opt ѡ
+ * @return ɹtrueѡδ֪ȡֵЧʱ󲢷false
+ */
+static bool parseOptions(int argc, char* argv[], CliOptions& opt) {
+	for (int i = 2; i < argc; ++i) {
+		string arg = argv[i];
+		auto value = [&](string& out) {
+			if (i + 1 >= argc) {
+				cerr << "[] ѡȱٲ: " << arg << endl;
+				return false;
+			}
+			out = argv[++i];
+			return true;
+		};
+
+		string v;
+		size_t n = 0;
+		if (arg == "-m" || arg == "--mode") {
+			if (!value(v)) return false;
+			if (!parseMode(v, opt.ctx)) { cerr << "[] Чģʽ: " << v << endl; return false; }
+			opt.modeSet = true;
+		}
+		else if (arg == "-c" || arg == "--mask") {
+			if (!value(v)) return false;
+			if (!parseMask(v, opt.ctx.channelMask)) { cerr << "[] Чͨ: " << v << endl; return false; }
+		}
+		else if (arg == "-p" || arg == "--password") {
+			if (!value(opt.ctx.password)) return false;
+		}
+		else if (arg == "-a" || arg == "--auto") {
+			opt.ctx.autoDetect = true;
+			opt.modeSet = true;
+		}
+		else if (arg == "--layout") {
+			if (!value(v)) return false;
+			if (v == "rows") opt.ctx.layout = STEGO_LAYOUT_ROWS;
+			else if (v == "legacy") opt.ctx.layout = STEGO_LAYOUT_LEGACY;
+			else { cerr << "[] Ч岼: " << v << endl; return false; }
+		}
+		else if (arg == "--checksum") {
+			if (!value(v)) return false;
+			if (v == "crc32") opt.ctx.checksum = CHECKSUM_CRC32;
+			else if (v == "crc32c") opt.ctx.checksum = CHECKSUM_CRC32C;
+			else if (v == "legacy") opt.ctx.checksum = CHECKSUM_LEGACY;
+			else { cerr << "[] ЧУ㷨: " << v << endl; return false; }
+		}
+		else if (arg == "--chunk") {
+			if (!value(v)) return false;
+			if (!parseCount(v, n) || n == 0 || n > 1024 * 1024) { cerr << "[] ЧĿС: " << v << endl; return false; }
+			opt.ctx.chunkSize = static_cast<uint32_t>(n * 1024);
+		}
+		else if (arg == "-j" || arg == "--jobs") {
+			if (!value(v)) return false;
+			if (!parseCount(v, opt.workers)) { cerr << "[] Ч: " << v << endl; return false; }
+		}
+		else if (arg == "-t" || arg == "--threads") {
+			if (!value(v)) return false;
+			if (!parseCount(v, n)) { cerr << "[] Ч߳: " << v << endl; return false; }
+			opt.ctx.threads = static_cast<unsigned>(n);
+			opt.threadsSet = true;
+		}
+		else if (arg == "--memory") {
+			if (!value(v)) return false;
+			if (!parseCount(v, n) || n == 0) { cerr << "[] Чڴ: " << v << endl; return false; }
+			opt.memoryLimit = n * 1024 * 1024;
+		}
+		else if (arg == "--manifest") {
+			if (!value(opt.manifest)) return false;
+		}
+		else if (arg == "-i" || arg == "--input") {
+			if (!value(opt.input)) return false;
+		}
+		else if (arg == "-d" || arg == "--data") {
+			if (!value(opt.data)) return false;
+		}
+		else if (arg == "-o" || arg == "--output") {
+			if (!value(opt.output)) return false;
+		}
+		else if (arg == "--index") {
+			if (!value(v)) return false;
+			if (!parseCount(v, opt.index)) { cerr << "[] Чķֶ: " << v << endl; return false; }
+			opt.indexSet = true;
+		}
+		else if (arg == "--name") {
+			if (!value(opt.name)) return false;
+		}
+		else if (arg == "--segments") {
+			if (!value(v)) return false;
+			if (!parseCount(v, n) || n == 0 || n > 65535) { cerr << "[] Чķֶ: " << v << endl; return false; }
+			opt.maxSegments = n;
+		}
+		else if (arg.size() > 1 && arg[0] == '-') {
+			cerr << "[] δ֪ѡ: " << arg << endl;
+			return false;
+		}
+		else {
+			opt.paths.push_back(arg);
+		}
+	}
+
+	if (opt.workers == 0) opt.workers = ThreadPool::hardwareThreads();
+	// ִжʱĬϵ̣߳߳ɱCPU
+	if (!opt.threadsSet) opt.ctx.threads = (opt.workers > 1) ? 1 : 0;
+	return true;
+}
+
+/**
+ * @brief ȡ嵥
+ * @param[in] path 嵥ļ·
+ * @param[in] defaults δָʹõд
+ * @param[out] jobs б
+ * @return ɹtrueļ޷򿪻ĳиʽʱfalse
+ */
+static bool readManifest(const string& path, const StegoContext& defaults, vector<CliJob>& jobs) {
+	ifstream in(path);
+	if (!in.is_open()) {
+		cerr << "[] ޷嵥ļ: " << path << endl;
+		return false;
+	}
+
+	string line;
+	size_t lineNo = 0;
+	while (getline(in, line)) {
+		++lineNo;
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty() || line[0] == '#') continue;
+
+		vector<string> cols;
+		stringstream ss(line);
+		string col;
+		while (getline(ss, col, '\t')) cols.push_back(col);
+		if (lineNo == 1 && !cols.empty() && cols[0] == "cover") continue;
+		if (cols.size() < 3) {
+			cerr << "[] 嵥 " << lineNo << " Ҫ3(塢ݡ)" << endl;
+			return false;
+		}
+
+		CliJob job;
+		job.cover = cols[0];
+		job.payload = cols[1];
+		job.output = cols[2];
+		job.ctx = defaults;
+		if (cols.size() > 3 && cols[3] != "-" && !parseMode(cols[3], job.ctx)) {
+			cerr << "[] 嵥 " << lineNo << " ģʽЧ: " << cols[3] << endl;
+			return false;
+		}
+		if (cols.size() > 4 && cols[4] != "-" && !parseMask(cols[4], job.ctx.channelMask)) {
+			cerr << "[] 嵥 " << lineNo << " ͨЧ: " << cols[4] << endl;
+			return false;
+		}
+		if (cols.size() > 5 && cols[5] != "-") job.ctx.password = cols[5];
+		jobs.push_back(job);
+	}
+	return true;
+}
+
+/**
+ * @brief ڹ̶Ĺִ߳count
+ * @param[in] count 
+ * @param[in] workers ͬʱִе(߳)
+ * @param[in] body 
+ */
+static void forEachJob(size_t count, size_t workers, const function<void(size_t)>& body) {
+	workers = min(workers, count);
+	if (workers > 1) {
+		ThreadPool pool(workers - 1);
+		pool.parallelFor(count, body);
+	}
+	else {
+		for (size_t i = 0; i < count; ++i) body(i);
+	}
+}
+
+/**
+ * @brief ȡļС
+ * @param[in] path ļ·
+ * @return ļС(ֽ)޷ʱΪ0
+ */
+static size_t fileSize(const string& path) {
+	ifstream in(path, ios::binary | ios::ate);
+	if (!in.is_open()) return 0;
+	streamoff size = in.tellg();
+	return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+/**
+ * @brief ִڼڴռ
+ *
+ * ʽд1MB黺ʱΪдʱƸ޸ĵҳΪ壻
+ * ģʽ(ܳģʽԶ)λñΪݴС4
+ *
+ * @param[in] job 
+ * @param[in] hide ǷΪ
+ * @param[in] coverSize ļС(ֽ)
+ * @return ֽ
+ */
+static size_t estimateJobMemory(const CliJob& job, bool hide, size_t coverSize) {
+	size_t bytes = 2 * 1024 * 1024;
+	if (hide) bytes += coverSize;
+	bool random = job.ctx.mode == LSB_RANDOM || (!hide && job.ctx.autoDetect && !job.ctx.password.empty());
+	if (random) bytes += coverSize * 4;
+	return bytes;
+}
+
+/**
+ * @brief ִһ
+ * @param[in] job 
+ * @param[in] covers ģ建棬ͬһĶһμ
+ * @param[out] payloadBytes صݳ
+ * @return ɹtrue
+ */
+static bool runHideJob(const CliJob& job, CoverCache& covers, size_t& payloadBytes) {
+	StegoCore core;
+	BmpImage bmp;
+	if (!covers.acquireClone(job.cover, bmp)) return false;
+
+	ifstream fin(job.payload, ios::binary | ios::ate);
+	if (!fin.is_open()) {
+		cerr << "[] ޷ļ: " << job.payload << endl;
+		return false;
+	}
+	streamoff sz = fin.tellg();
+	if (sz <= 0 || static_cast<unsigned long long>(sz) > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ļСϷ: " << job.payload << endl;
+		return false;
+	}
+	fin.seekg(0, ios::beg);
+
+	if (!core.hideStream(bmp, fin, static_cast<size_t>(sz), job.ctx)) return false;
+	if (!bmp.save(job.output)) return false;
+	payloadBytes = static_cast<size_t>(sz);
+	return true;
+}
+
+/**
+ * @brief ִһȡ
+ * @param[in] job 
+ * @param[out] payloadBytes ȡݳ
+ * @param[out] ctx ȡд(ԶʱΪ)
+ * @return ɹtrueʧʱɾдļ
+ */
+static bool runExtractJob(const CliJob& job, size_t& payloadBytes, StegoContext& ctx) {
+	StegoCore core;
+	BmpImage bmp;
+	if (!bmp.load(job.cover, BMP_MAP_READONLY)) return false;
+
+	ofstream fout(job.output, ios::binary);
+	if (!fout.is_open()) {
+		cerr << "[] ޷ļ: " << job.output << endl;
+		return false;
+	}
+	ctx = job.ctx;
+	bool ok = core.extractStream(bmp, fout, payloadBytes, ctx);
+	fout.close();
+	if (!ok) remove(job.output.c_str());
+	return ok;
+}
+
+/**
+ * @brief 
+ * @param[in] title 
+ * @param[in] ok ɹ
+ * @param[in] total 
+ * @param[in] payloadBytes ɹ(ֽ)0ʾͳ
+ * @param[in] coverBytes ļܴС(ֽ)
+ * @param[in] ms ʱ()
+ */
+static void printSummary(const char* title, size_t ok, size_t total, size_t payloadBytes,
+	size_t coverBytes, double ms) {
+	const double mb = 1024.0 * 1024.0;
+	double seconds = max(ms, 1e-3) / 1000.0;
+	cerr << " " << title << "  \n"
+		<< ": ɹ " << ok << " /  " << total << "ʧ " << (total - ok) << "\n"
+		<< fixed << setprecision(1)
+		<< "ʱ: " << ms << " ms" << (total / seconds) << " ļ/\n";
+	if (payloadBytes > 0) {
+		cerr << ": " << (payloadBytes / mb) << " MB" << (payloadBytes / mb / seconds) << " MB/\n";
+	}
+	cerr << ": " << (coverBytes / mb) << " MB" << (coverBytes / mb / seconds) << " MB/\n"
+		<< defaultfloat;
+}
+
+/**
+ * @brief ִhideextract
+ * @param[in] opt ѡ
+ * @param[in] hide trueΪhidefalseΪextract
+ * @return ˳
+ */
+static int runTransfer(const CliOptions& opt, bool hide) {
+	vector<CliJob> jobs;
+	if (!opt.manifest.empty()) {
+		if (!readManifest(opt.manifest, opt.ctx, jobs)) return 2;
+	}
+	else {
+		if (opt.input.empty() || opt.output.empty() || (hide && opt.data.empty())) {
+			cerr << "[] ȱ -i/-o" << (hide ? "/-d" : "") << "  --manifest" << endl;
+			printUsage();
+			return 2;
+		}
+		jobs.push_back(CliJob{ opt.input, opt.data, opt.output, opt.ctx });
+	}
+	if (hide) {
+		for (const CliJob& job : jobs) {
+			if (job.ctx.autoDetect) {
+				cerr << "[] ʱʹԶģʽ: " << job.cover << endl;
+				return 2;
+			}
+		}
+	}
+
+	MemoryBudget budget(opt.memoryLimit);
+	CoverCache covers;
+	mutex outMutex;
+	atomic<size_t> succeeded(0);
+	atomic<size_t> payloadTotal(0);
+	atomic<size_t> coverTotal(0);
+	auto start = chrono::steady_clock::now();
+
+	forEachJob(jobs.size(), opt.workers, [&](size_t i) {
+		const CliJob& job = jobs[i];
+		size_t coverSize = fileSize(job.cover);
+		size_t cost = estimateJobMemory(job, hide, coverSize);
+		budget.acquire(cost);
+
+		auto t0 = chrono::steady_clock::now();
+		size_t bytes = 0;
+		StegoContext result = job.ctx;
+		bool ok = hide ? runHideJob(job, covers, bytes) : runExtractJob(job, bytes, result);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+		budget.release(cost);
+
+		coverTotal += coverSize;
+		if (ok) {
+			++succeeded;
+			payloadTotal += bytes;
+		}
+
+		lock_guard<mutex> lock(outMutex);
+		cout << (ok ? "[ɹ] " : "[ʧ] ") << job.cover << " -> " << job.output;
+		if (ok) {
+			cout << " (" << bytes << " ֽ";
+			if (!hide) cout << ", " << modeKey(result.mode) << " 0x0" << result.channelMask;
+			cout << ", " << fixed << setprecision(1) << ms << " ms)" << defaultfloat;
+		}
+		cout << endl;
+	});
+
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	printSummary(hide ? "hide" : "extract", succeeded.load(), jobs.size(), payloadTotal.load(), coverTotal.load(), ms);
+	if (hide) {
+		CoverCacheStats cache = covers.stats();
+		cerr << ": " << (cache.misses + cache.reloads) << " Σ " << cache.hits << " " << endl;
+	}
+	return succeeded.load() == jobs.size() ? 0 : 1;
+}
+
+/**
+ * @brief иļĿ¼չΪBMPļб
+ * @param[in] opt ѡ(pathsmanifest嵥ֻȡһ)
+ * @param[out] files ļб
+ * @return ɹtrue
+ */
+static bool collectFiles(const CliOptions& opt, vector<string>& files) {
+	vector<string> inputs = opt.paths;
+	if (!opt.manifest.empty()) {
+		ifstream in(opt.manifest);
+		if (!in.is_open()) {
+			cerr << "[] ޷嵥ļ: " << opt.manifest << endl;
+			return false;
+		}
+		string line;
+		while (getline(in, line)) {
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line.empty() || line[0] == '#') continue;
+			inputs.push_back(line.substr(0, line.find('\t')));
+		}
+	}
+	if (inputs.empty()) {
+		cerr << "[] δָļĿ¼" << endl;
+		printUsage();
+		return false;
+	}
+
+	for (const string& path : inputs) {
+		if (!isDirectory(path)) {
+			files.push_back(path);
+			continue;
+		}
+		vector<string> listed;
+		if (!listDirectory(path, ".bmp", listed)) return false;
+		files.insert(files.end(), listed.begin(), listed.end());
+	}
+	return true;
+}
+
+/**
+ * @brief ִprobeֻȡͷжϸļǷд
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runProbe(const CliOptions& opt) {
+	vector<string> files;
+	if (!collectFiles(opt, files)) return 2;
+
+	struct ProbeResult {
+		bool        found = false;
+		StegoHeader header{};
+		StegoContext ctx;
+	};
+	vector<ProbeResult> results(files.size());
+	// δָģʽʱȫ˳/ǿģʽϣģʽͷλȡͼ޷ֻͷж
+	StegoContext defaults = opt.ctx;
+	if (!opt.modeSet) defaults.autoDetect = true;
+	if (!defaults.autoDetect && defaults.mode != LSB_SEQUENTIAL && defaults.mode != LSB_ENHANCED) {
+		cerr << "[] probe ֻ֧˳/ǿģʽ" << endl;
+		return 2;
+	}
+
+	StegoCore core;
+	atomic<size_t> coverTotal(0);
+	auto start = chrono::steady_clock::now();
+	forEachJob(files.size(), opt.workers, [&](size_t i) {
+		results[i].ctx = defaults;
+		results[i].found = core.probeFile(files[i], results[i].header, results[i].ctx);
+		coverTotal += fileSize(files[i]);
+	});
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	size_t found = 0;
+	cout << "path\tstatus\tlength\tmode\tmask\tlayout\n";
+	for (size_t i = 0; i < files.size(); ++i) {
+		const ProbeResult& r = results[i];
+		cout << files[i] << '\t';
+		if (!r.found) {
+			cout << "none\t-\t-\t-\t-\n";
+			continue;
+		}
+		++found;
+		cout << "found\t" << r.header.dataLength << '\t' << modeKey(r.ctx.mode) << "\t0x0" << r.ctx.channelMask
+			<< '\t' << (r.ctx.layout == STEGO_LAYOUT_ROWS ? "rows" : "legacy") << '\n';
+	}
+	cout.flush();
+	// probe"ɹ"ָɣдݵļг
+	printSummary("probe", files.size(), files.size(), 0, coverTotal.load(), ms);
+	cerr << "дͷ: " << found << " / " << files.size() << endl;
+	return 0;
+}
+
+/**
+ * @brief ִverifyУļȫݲг𻵵ֽڷΧ
+ * @param[in] opt ѡ
+ * @return ˳룬ļδҵݻʱΪ1
+ */
+static int runVerify(const CliOptions& opt) {
+	vector<string> files;
+	if (!collectFiles(opt, files)) return 2;
+
+	struct VerifyResult {
+		bool                   found = false;
+		size_t                 length = 0;
+		vector<StegoByteRange> damaged;
+	};
+	vector<VerifyResult> results(files.size());
+	StegoContext defaults = opt.ctx;
+	if (!opt.modeSet) defaults.autoDetect = true;
+
+	StegoCore core;
+	atomic<size_t> coverTotal(0);
+	auto start = chrono::steady_clock::now();
+	forEachJob(files.size(), opt.workers, [&](size_t i) {
+		BmpImage bmp;
+		StegoContext ctx = defaults;
+		if (bmp.load(files[i], BMP_MAP_READONLY)) {
+			results[i].found = core.verifyData(bmp, results[i].damaged, results[i].length, ctx);
+		}
+		coverTotal += fileSize(files[i]);
+	});
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	size_t intact = 0;
+	cout << "path\tstatus\tlength\tdamaged\n";
+	for (size_t i = 0; i < files.size(); ++i) {
+		const VerifyResult& r = results[i];
+		cout << files[i] << '\t';
+		if (!r.found) {
+			cout << "none\t-\t-\n";
+			continue;
+		}
+		if (r.damaged.empty()) {
+			++intact;
+			cout << "ok\t" << r.length << "\t-\n";
+			continue;
+		}
+		// 𻵷Χд뿪-յ㣬Զŷָ
+		cout << "damaged\t" << r.length << '\t';
+		for (size_t k = 0; k < r.damaged.size(); ++k) {
+			cout << (k ? "," : "") << r.damaged[k].offset << '-' << r.damaged[k].offset + r.damaged[k].length;
+		}
+		cout << '\n';
+	}
+	cout.flush();
+	printSummary("verify", intact, files.size(), 0, coverTotal.load(), ms);
+	return intact == files.size() ? 0 : 1;
+}
+
+/**
+ * @brief ִcapacityֻȡͷͳƸļд
+ * @param[in] opt ѡ(˳/ǿģʽʹеlayout)
+ * @return ˳
+ */
+static int runCapacity(const CliOptions& opt) {
+	vector<string> files;
+	if (!collectFiles(opt, files)) return 2;
+
+	StegoCore core;
+	vector<CoverCapacity> covers(files.size());
+	auto start = chrono::steady_clock::now();
+	forEachJob(files.size(), opt.workers, [&](size_t i) {
+		core.queryCapacity(files[i], covers[i], opt.ctx);
+	});
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	// ÿ(ģʽ, ͨ)һУһΪȫЧļĺϼ
+	cout << "path\twidth\theight\tbits";
+	for (int m = 0; m < CoverCapacity::kModes; ++m) {
+		for (int k = 0; k < CoverCapacity::kMasks; ++k) {
+			cout << '\t' << modeKey(static_cast<SteganoMode>(m)) << ":0x0" << (k + 1);
+		}
+	}
+	cout << '\n';
+
+	size_t total[CoverCapacity::kModes][CoverCapacity::kMasks] = {};
+	size_t valid = 0;
+	for (const CoverCapacity& cover : covers) {
+		if (!cover.valid) continue;
+		++valid;
+		cout << cover.path << '\t' << cover.width << '\t' << cover.height << '\t' << cover.bitCount;
+		for (int m = 0; m < CoverCapacity::kModes; ++m) {
+			for (int k = 0; k < CoverCapacity::kMasks; ++k) {
+				cout << '\t' << cover.capacity[m][k];
+				total[m][k] += cover.capacity[m][k];
+			}
+		}
+		cout << '\n';
+	}
+	cout << "total\t-\t-\t-";
+	for (int m = 0; m < CoverCapacity::kModes; ++m) {
+		for (int k = 0; k < CoverCapacity::kMasks; ++k) cout << '\t' << total[m][k];
+	}
+	cout << endl;
+
+	// capacityֻȡͷС
+	printSummary("capacity", valid, covers.size(), 0, 0, ms);
+	return valid == covers.size() ? 0 : 1;
+}
+
+/**
+ * @brief ȡ·еļ
+ * @param[in] path ·
+ * @return һ·ָ֮Ĳ
+ */
+static string baseName(const string& path) {
+	size_t pos = path.find_last_of("/\\");
+	return pos == string::npos ? path : path.substr(pos + 1);
+}
+
+/**
+ * @brief ȡsplit/joinʹõд
+ * @param[in] opt ѡ
+ * @return дδ-tָ߳ʱʹ-jֵ
+ */
+static StegoContext shardContext(const CliOptions& opt) {
+	StegoContext ctx = opt.ctx;
+	if (!opt.threadsSet) ctx.threads = static_cast<unsigned>(opt.workers);
+	return ctx;
+}
+
+/**
+ * @brief ȡļ
+ * @param[in] path ļ·
+ * @param[out] data ļ
+ * @return ɹļǿʱtrue
+ */
+static bool readDataFile(const string& path, vector<char>& data) {
+	ifstream fin(path, ios::binary);
+	if (!fin.is_open()) {
+		cerr << "[] ޷ļ: " << path << endl;
+		return false;
+	}
+	data.assign(istreambuf_iterator<char>(fin), istreambuf_iterator<char>());
+	if (data.empty()) {
+		cerr << "[] ļΪ: " << path << endl;
+		return false;
+	}
+	return true;
+}
+
+
+/**
+ * @brief ִsplitݷƬص
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runSplit(const CliOptions& opt) {
+	if (opt.data.empty() || opt.output.empty()) {
+		cerr << "[] ȱ -d/-o" << endl;
+		printUsage();
+		return 2;
+	}
+	if (opt.ctx.autoDetect) {
+		cerr << "[] ʱʹԶģʽ" << endl;
+		return 2;
+	}
+	if (!isDirectory(opt.output)) {
+		cerr << "[] Ŀ¼: " << opt.output << endl;
+		return 2;
+	}
+	vector<string> files;
+	if (!collectFiles(opt, files)) return 2;
+
+	vector<char> data;
+	if (!readDataFile(opt.data, data)) return 1;
+
+	auto start = chrono::steady_clock::now();
+	vector<BmpImage> covers(files.size());
+	size_t coverBytes = 0;
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (!covers[i].load(files[i], BMP_MAP_PRIVATE)) return 1;
+		coverBytes += fileSize(files[i]);
+	}
+
+	StegoCore core;
+	vector<size_t> used;
+	if (!core.hideSharded(covers, data.data(), data.size(), shardContext(opt), used)) return 1;
+
+	size_t saved = 0;
+	for (size_t s = 0; s < used.size(); ++s) {
+		const string& cover = files[used[s]];
+		string output = opt.output + "/" + baseName(cover);
+		bool ok = covers[used[s]].save(output);
+		if (ok) ++saved;
+		cout << (ok ? "[ɹ] " : "[ʧ] ") << cover << " -> " << output
+			<< " (Ƭ " << s + 1 << "/" << used.size() << ")" << endl;
+	}
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	printSummary("split", saved, used.size(), data.size(), coverBytes, ms);
+	return saved == used.size() ? 0 : 1;
+}
+
+/**
+ * @brief ִjoinռƬΪԭʼ
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runJoin(const CliOptions& opt) {
+	if (opt.output.empty()) {
+		cerr << "[] ȱ -o" << endl;
+		printUsage();
+		return 2;
+	}
+	vector<string> files;
+	if (!collectFiles(opt, files)) return 2;
+
+	auto start = chrono::steady_clock::now();
+	vector<BmpImage> images(files.size());
+	size_t coverBytes = 0;
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (!images[i].load(files[i], BMP_MAP_READONLY)) return 1;
+		coverBytes += fileSize(files[i]);
+	}
+
+	StegoCore core;
+	StegoContext ctx = shardContext(opt);
+	if (!opt.modeSet) ctx.autoDetect = true;
+	char* data = nullptr;
+	size_t length = 0;
+	if (!core.extractSharded(images, data, length, ctx)) return 1;
+	unique_ptr<char[]> owner(data);
+
+	ofstream fout(opt.output, ios::binary);
+	if (!fout.is_open()) {
+		cerr << "[] ޷ļ: " << opt.output << endl;
+		return 1;
+	}
+	fout.write(data, static_cast<streamsize>(length));
+	fout.close();
+	if (!fout) {
+		cerr << "[] дʧ: " << opt.output << endl;
+		remove(opt.output.c_str());
+		return 1;
+	}
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << "[ɹ] -> " << opt.output << " (" << length << " ֽ, " << modeKey(ctx.mode)
+		<< " 0x0" << ctx.channelMask << ")" << endl;
+	printSummary("join", 1, 1, length, coverBytes, ms);
+	return 0;
+}
+
+/**
+ * @brief ִappend/updateֶ׷ӷֶλ滻ֶָ
+ *
+ * δ-oʱԭ޸ͼ񣬱ʱֻдر޸ĵֽڡ
+ * appendʱͼûзֶ-mָģʽȰѡ½ֶ(ֶ--segments)
+ *
+ * @param[in] opt ѡ
+ * @param[in] update trueΪupdatefalseΪappend
+ * @return ˳
+ */
+static int runSegmentWrite(const CliOptions& opt, bool update) {
+	if (opt.input.empty() || opt.data.empty() || (update && !opt.indexSet)) {
+		cerr << (update ? "[] ȱ -i/-d/--index" : "[] ȱ -i/-d") << endl;
+		printUsage();
+		return 2;
+	}
+	vector<char> data;
+	if (!readDataFile(opt.data, data)) return 1;
+
+	auto start = chrono::steady_clock::now();
+	BmpImage bmp;
+	if (!bmp.load(opt.input, BMP_MAP_PRIVATE)) return 1;
+
+	StegoCore core;
+	StegoContext ctx = shardContext(opt);
+	if (!opt.modeSet) ctx.autoDetect = true;
+	size_t index = opt.index;
+	bool ok = false;
+	if (update) {
+		ok = core.replaceSegment(bmp, index, data.data(), data.size(), ctx);
+	}
+	else {
+		vector<StegoSegmentEntry> segments;
+		StegoContext probe = ctx;
+		if (!core.listSegments(bmp, segments, probe)) {
+			if (ctx.autoDetect) {
+				cerr << "[] δҵֶдݣ½ʱ -m ָģʽ" << endl;
+				return 1;
+			}
+			if (!core.createSegmented(bmp, ctx, opt.maxSegments)) return 1;
+			cerr << "[Ϣ] ½ֶݣֶ " << opt.maxSegments << endl;
+		}
+		ok = core.appendSegment(bmp, data.data(), data.size(), ctx, index);
+	}
+
+	string output = opt.output.empty() ? opt.input : opt.output;
+	ok = ok && bmp.save(output);
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << (ok ? "[ɹ] " : "[ʧ] ") << opt.input << " -> " << output;
+	if (ok) cout << " (ֶ " << index << ", " << data.size() << " ֽ)";
+	cout << endl;
+	printSummary(update ? "update" : "append", ok ? 1 : 0, 1, data.size(), fileSize(output), ms);
+	return ok ? 0 : 1;
+}
+
+/**
+ * @brief ִsegmentsгֶα--index-oȡֶ
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runSegments(const CliOptions& opt) {
+	if (opt.input.empty() || (opt.indexSet != !opt.output.empty())) {
+		cerr << "[] ȱ -i --index  -o δͬʱ" << endl;
+		printUsage();
+		return 2;
+	}
+	BmpImage bmp;
+	if (!bmp.load(opt.input, BMP_MAP_READONLY)) return 1;
+
+	StegoCore core;
+	StegoContext ctx = shardContext(opt);
+	if (!opt.modeSet) ctx.autoDetect = true;
+	if (!opt.indexSet) {
+		vector<StegoSegmentEntry> segments;
+		if (!core.listSegments(bmp, segments, ctx)) {
+			cerr << "[] δҵֶд" << endl;
+			return 1;
+		}
+		cout << "index\toffset\tlength\tcrc\n";
+		for (size_t i = 0; i < segments.size(); ++i) {
+			cout << i << '\t' << segments[i].offset << '\t' << segments[i].length << "\t0x" << hex << setw(8)
+				<< setfill('0') << segments[i].crc << dec << setfill(' ') << '\n';
+		}
+		cout.flush();
+		cerr << "ֶ: " << segments.size() << " (" << modeKey(ctx.mode) << " 0x0" << ctx.channelMask << ")" << endl;
+		return 0;
+	}
+
+	char* data = nullptr;
+	size_t length = 0;
+	if (!core.extractSegment(bmp, opt.index, data, length, ctx)) return 1;
+	unique_ptr<char[]> owner(data);
+	ofstream fout(opt.output, ios::binary);
+	if (!fout.is_open()) {
+		cerr << "[] ޷ļ: " << opt.output << endl;
+		return 1;
+	}
+	fout.write(data, static_cast<streamsize>(length));
+	fout.close();
+	if (!fout) {
+		cerr << "[] дʧ: " << opt.output << endl;
+		remove(opt.output.c_str());
+		return 1;
+	}
+	cout << "[ɹ] " << opt.input << " -> " << opt.output << " (ֶ " << opt.index << ", " << length << " ֽ)" << endl;
+	return 0;
+}
+
+/**
+ * @brief ִpackļΪص
+ *
+ * Աȡļļظʱ
+ *
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runPack(const CliOptions& opt) {
+	if (opt.input.empty() || opt.output.empty() || opt.paths.empty()) {
+		cerr << "[] ȱ -i/-o Աļ" << endl;
+		printUsage();
+		return 2;
+	}
+	if (opt.ctx.autoDetect) {
+		cerr << "[] ʱʹԶģʽ" << endl;
+		return 2;
+	}
+
+	auto start = chrono::steady_clock::now();
+	vector<vector<char>> contents(opt.paths.size());
+	vector<ArchiveMember> members(opt.paths.size());
+	size_t payload = 0;
+	for (size_t i = 0; i < opt.paths.size(); ++i) {
+		if (!readDataFile(opt.paths[i], contents[i])) return 1;
+		members[i].name = baseName(opt.paths[i]);
+		members[i].data = contents[i].data();
+		members[i].length = contents[i].size();
+		payload += contents[i].size();
+	}
+
+	BmpImage bmp;
+	if (!bmp.load(opt.input, BMP_MAP_PRIVATE)) return 1;
+	StegoCore core;
+	bool ok = core.hideArchive(bmp, members, shardContext(opt)) && bmp.save(opt.output);
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << (ok ? "[ɹ] " : "[ʧ] ") << opt.input << " -> " << opt.output;
+	if (ok) cout << " (" << members.size() << " Ա, " << payload << " ֽ)";
+	cout << endl;
+	printSummary("pack", ok ? 1 : 0, 1, payload, fileSize(opt.input), ms);
+	return ok ? 0 : 1;
+}
+
+/**
+ * @brief ִmembersгԱ--name-oȡԱ
+ * @param[in] opt ѡ
+ * @return ˳
+ */
+static int runMembers(const CliOptions& opt) {
+	if (opt.input.empty() || opt.name.empty() != opt.output.empty()) {
+		cerr << "[] ȱ -i --name  -o δͬʱ" << endl;
+		printUsage();
+		return 2;
+	}
+	BmpImage bmp;
+	if (!bmp.load(opt.input, BMP_MAP_READONLY)) return 1;
+
+	StegoCore core;
+	StegoContext ctx = shardContext(opt);
+	if (!opt.modeSet) ctx.autoDetect = true;
+	if (opt.name.empty()) {
+		vector<StegoMemberInfo> members;
+		if (!core.listMembers(bmp, members, ctx)) return 1;
+		cout << "name\toffset\tlength\tcrc\n";
+		for (const StegoMemberInfo& m : members) {
+			cout << m.name << '\t' << m.offset << '\t' << m.length << "\t0x" << hex << setw(8) << setfill('0')
+				<< m.crc << dec << setfill(' ') << '\n';
+		}
+		cout.flush();
+		cerr << "Ա: " << members.size() << " (" << modeKey(ctx.mode) << " 0x0" << ctx.channelMask << ")" << endl;
+		return 0;
+	}
+
+	char* data = nullptr;
+	size_t length = 0;
+	if (!core.extractMember(bmp, opt.name, data, length, ctx)) return 1;
+	unique_ptr<char[]> owner(data);
+	ofstream fout(opt.output, ios::binary);
+	if (!fout.is_open()) {
+		cerr << "[] ޷ļ: " << opt.output << endl;
+		return 1;
+	}
+	fout.write(data, static_cast<streamsize>(length));
+	fout.close();
+	if (!fout) {
+		cerr << "[] дʧ: " << opt.output << endl;
+		remove(opt.output.c_str());
+		return 1;
+	}
+	cout << "[ɹ] " << opt.input << " -> " << opt.output << " (" << opt.name << ", " << length << " ֽ)" << endl;
+	return 0;
+}
+
+/**
+ * @brief ִ
+ * @param[in] argc 
+ * @param[in] argv б
+ * @return ˳
+ */
+int runCommandLine(int argc, char* argv[]) {
+	string command = argv[1];
+	if (command == "-h" || command == "--help" || command == "help") {
+		printUsage();
+		return 0;
+	}
+
+	CliOptions opt;
+	if (!parseOptions(argc, argv, opt)) {
+		printUsage();
+		return 2;
+	}
+
+	if (command == "hide") return runTransfer(opt, true);
+	if (command == "extract") return runTransfer(opt, false);
+	if (command == "probe") return runProbe(opt);
+	if (command == "capacity") return runCapacity(opt);
+	if (command == "split") return runSplit(opt);
+	if (command == "join") return runJoin(opt);
+	if (command == "append") return runSegmentWrite(opt, false);
+	if (command == "update") return runSegmentWrite(opt, true);
+	if (command == "segments") return runSegments(opt);
+	if (command == "pack") return runPack(opt);
+	if (command == "members") return runMembers(opt);
+	if (command == "verify") return runVerify(opt);
+
+	cerr << "[] δ֪: " << command << endl;
+	printUsage();
+	return 2;
+}
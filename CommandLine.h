@@ -0,0 +1,21 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+/**
+ * @file CommandLine.h
+ * @brief ǽʽ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ṩhideextractprobecapacityȫѡ嵥ļ
+ * ڽűʱԽ뽻ʽ˵
+ */
+
+/**
+ * @brief ִ
+ * @param[in] argc 
+ * @param[in] argv бargv[1]Ϊ
+ * @return ˳룺0ʾȫɹ1ʾʧܣ2ʾ
+ */
+int runCommandLine(int argc, char* argv[]);
+
+#endif // COMMAND_LINE_H
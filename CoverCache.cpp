@@ -0,0 +1,134 @@
+#include "CoverCache.h"
+#include <iostream>
+
+/**
+ * @file CoverCache.cpp
+ * @brief ģ建ʵ
+ * @copyright Copyright 2025, Ϣص6
+ */
+
+using namespace std;
+
+const size_t CoverCache::kDefaultCapacity;
+
+/**
+ * @brief 컺
+ * @param[in] capacity Ŀ
+ */
+CoverCache::CoverCache(size_t capacity)
+{
+	m_stats.capacity = capacity;
+}
+
+/**
+ * @brief ȡģ壬δлļѱ仯ʱ
+ *
+ * (ֻӳֻͷʱͼС޹)
+ * ߳ͬʱδͬһ·ʱԼأɵĽɵġ
+ *
+ * @param[in] path ļ·
+ * @return ģĹָ룬ʧʱΪnullptr
+ */
+CoverCache::TemplatePtr CoverCache::acquire(const std::string& path)
+{
+	FileStamp stamp;
+	if (!fileStamp(path, stamp)) {
+		cerr << "[] ޷ļ: " << path << endl;
+		return nullptr;
+	}
+
+	unique_lock<mutex> lock(m_mutex);
+	auto it = m_entries.find(path);
+	bool stale = false;
+	if (it != m_entries.end()) {
+		if (it->second.stamp == stamp) {
+			++m_stats.hits;
+			m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+			return it->second.image;
+		}
+		stale = true;
+	}
+	if (stale) ++m_stats.reloads;
+	else ++m_stats.misses;
+	lock.unlock();
+
+	shared_ptr<BmpImage> image = make_shared<BmpImage>();
+	if (!image->load(path, BMP_MAP_READONLY)) return nullptr;
+
+	lock.lock();
+	if (m_stats.capacity == 0) return image;
+	it = m_entries.find(path);
+	if (it == m_entries.end()) {
+		m_lru.push_front(path);
+		Entry& entry = m_entries[path];
+		entry.lruPos = m_lru.begin();
+		it = m_entries.find(path);
+	}
+	else {
+		m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+	}
+	it->second.stamp = stamp;
+	it->second.image = image;
+	evictLocked();
+	return image;
+}
+
+/**
+ * @brief ȡдʱƸ
+ * @param[in] path ļ·
+ * @param[out] clone 
+ * @return ɹtrueʧܷfalse
+ */
+bool CoverCache::acquireClone(const std::string& path, BmpImage& clone)
+{
+	TemplatePtr image = acquire(path);
+	return image && image->cloneCopyOnWrite(clone);
+}
+
+/**
+ * @brief LRU˳̭ĿֱĿ
+ * @note ÷m_mutex
+ */
+void CoverCache::evictLocked()
+{
+	while (m_entries.size() > m_stats.capacity && !m_lru.empty()) {
+		m_entries.erase(m_lru.back());
+		m_lru.pop_back();
+		++m_stats.evictions;
+	}
+	m_stats.entries = m_entries.size();
+}
+
+/**
+ * @brief Ŀޣ̭
+ * @param[in] capacity Ŀ
+ */
+void CoverCache::setCapacity(size_t capacity)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_stats.capacity = capacity;
+	evictLocked();
+}
+
+/**
+ * @brief ջĿ(ͳƼ)
+ */
+void CoverCache::clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+	m_stats.entries = 0;
+}
+
+/**
+ * @brief ȡͳϢ
+ * @return ͳϢ
+ */
+CoverCacheStats CoverCache::stats() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	CoverCacheStats snapshot = m_stats;
+	snapshot.entries = m_entries.size();
+	return snapshot;
+}
@@ -0,0 +1,103 @@
+#ifndef COVER_CACHE_H
+#define COVER_CACHE_H
+
+#include "BmpImage.h"
+#include "FileSystem.h"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <cstddef>
+
+/**
+ * @file CoverCache.h
+ * @brief ģ建
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ͬһ巴زͬʱֻһļֻӳ䣬
+ * ֮ÿȡһдʱƸȥظļظơ
+ */
+
+/**
+ * @struct CoverCacheStats
+ * @brief ģ建ͳϢ
+ */
+struct CoverCacheStats {
+	size_t hits = 0;       ///< д
+	size_t misses = 0;     ///< δд(״μ)
+	size_t reloads = 0;    ///< ļС޸ʱ仯¼صĴ
+	size_t evictions = 0;  ///< 򳬳Ŀޱ̭Ŀ
+	size_t entries = 0;    ///< ǰĿ
+	size_t capacity = 0;   ///< Ŀ
+};
+
+/**
+ * @class CoverCache
+ * @brief (·, ļС, ޸ʱ)Ϊģ建
+ *
+ * ģֻӳ䷽ʽأռشС˽ڴ棬˰Ŀֽơ
+ * ÿλȡʱ²ѯļĴС޸ʱ䣬뻺ʱͬ¼ء
+ * ʹ˳̭̭Ӱȡõģ븱̰߳ȫ
+ * ģ븱ӳļļӦдļ滻ķʽ£ԭظдӰȡõĸ
+ */
+class CoverCache {
+public:
+	typedef std::shared_ptr<const BmpImage> TemplatePtr;
+
+	/**
+	 * @brief 컺
+	 * @param[in] capacity Ŀޣ0ʾû(ÿξ¼)
+	 */
+	explicit CoverCache(size_t capacity = kDefaultCapacity);
+
+	/**
+	 * @brief ȡģ壬δлļѱ仯ʱ
+	 * @param[in] path ļ·
+	 * @return ģĹָ룬ʧʱΪnullptr
+	 */
+	TemplatePtr acquire(const std::string& path);
+
+	/**
+	 * @brief ȡдʱƸ
+	 * @param[in] path ļ·
+	 * @param[out] clone ֱغ
+	 * @return ɹtrueʧܷfalse
+	 */
+	bool acquireClone(const std::string& path, BmpImage& clone);
+
+	/**
+	 * @brief Ŀޣ̭
+	 * @param[in] capacity Ŀ
+	 */
+	void setCapacity(size_t capacity);
+
+	/**
+	 * @brief ջĿ(ͳƼ)
+	 */
+	void clear();
+
+	/**
+	 * @brief ȡͳϢ
+	 * @return ͳϢ
+	 */
+	CoverCacheStats stats() const;
+
+	static const size_t kDefaultCapacity = 64; ///< ĬĿ
+
+private:
+	struct Entry {
+		FileStamp   stamp;                       ///< ʱļС޸ʱ
+		TemplatePtr image;                       ///< ģ
+		std::list<std::string>::iterator lruPos; ///< LRUеλ
+	};
+
+	void evictLocked();
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, Entry> m_entries;
+	std::list<std::string> m_lru;                ///< ͷΪʹ
+	CoverCacheStats m_stats;
+};
+
+#endif // COVER_CACHE_H
@@ -0,0 +1,65 @@
+#include "CpuFeatures.h"
+
+#if defined(STEGO_X86) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+/**
+ * @file CpuFeatures.cpp
+ * @brief ʱCPUԼʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * MSVCֱӶȡCPUID/XGETBVGCC/Clangʹcpuid.h__builtin_cpu_supports
+ */
+
+/**
+ * @brief CPU
+ * @return 
+ */
+static CpuFeatures detectCpuFeatures()
+{
+	CpuFeatures f;
+#ifdef STEGO_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	f.sse2 = (info[3] & (1 << 26)) != 0;
+	f.sse41 = (info[2] & (1 << 19)) != 0;
+	f.sse42 = (info[2] & (1 << 20)) != 0;
+	f.pclmul = (info[2] & (1 << 1)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		f.avx2 = (info[1] & (1 << 5)) != 0;
+		f.bmi2 = (info[1] & (1 << 8)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	f.sse2 = __builtin_cpu_supports("sse2");
+	f.sse41 = __builtin_cpu_supports("sse4.1");
+	f.sse42 = __builtin_cpu_supports("sse4.2");
+	f.avx2 = __builtin_cpu_supports("avx2");
+	f.bmi2 = __builtin_cpu_supports("bmi2");
+
+	// __builtin_cpu_supportsڽϾɵıϲʶpclmulֱӶȡCPUID
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		f.pclmul = (ecx & bit_PCLMUL) != 0;
+	}
+#endif
+#endif // STEGO_X86
+	return f;
+}
+
+/**
+ * @brief ȡǰCPU
+ * @return CPU
+ */
+const CpuFeatures& cpuFeatures()
+{
+	static const CpuFeatures features = detectCpuFeatures();
+	return features;
+}
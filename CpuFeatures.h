@@ -0,0 +1,46 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * @file CpuFeatures.h
+ * @brief ʱCPUԼ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * LSBںCRCУģ鰴CPUѡʵ֡
+ * STEGO_TARGETδӦѡʱΪָ(MSVCע)
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define STEGO_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define STEGO_TARGET(features)
+#else
+#define STEGO_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+ /**
+  * @struct CpuFeatures
+  * @brief ǰCPUֵָ֧չ
+  *
+  * x86ƽֶ̨ξΪfalse
+  */
+struct CpuFeatures {
+	bool sse2 = false;   ///< SSE2
+	bool sse41 = false;  ///< SSE4.1
+	bool sse42 = false;  ///< SSE4.2(crc32ָ)
+	bool pclmul = false; ///< PCLMULQDQ޽λ˷
+	bool avx2 = false;   ///< AVX2(ȷϲϵͳYMM״̬)
+	bool bmi2 = false;   ///< BMI2
+};
+
+/**
+ * @brief ȡǰCPU
+ * @note ״εʱ⣬֮󷵻ػ̰߳ȫ
+ * @return CPU
+ */
+const CpuFeatures& cpuFeatures();
+
+#endif // CPU_FEATURES_H
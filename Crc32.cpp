@@ -0,0 +1,409 @@
+#include "Crc32.h"
+#include "CpuFeatures.h"
+
+/**
+ * @file Crc32.cpp
+ * @brief Уֵʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ڲ״̬ΪȡCRCʽӿڽ뷵ʱȡһΣ
+ * ˷ֶμֻһεĽΪһεĳʼֵ
+ *
+ * PCLMULQDQ۵㷨μIntelƤ"Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction"Ϊλתµk1~k5BarrettԼ
+ * ÿβ۵64ֽڣ16ֽڵβslicing-by-8
+ */
+
+namespace {
+
+/**
+ * @brief ԭCRC32У256
+ *
+ * ɰ汾StegoCore.cppеԤԭڶʽ0xEDB88320
+ * 0xE3Ϊ0x003903C2(׼ֵΪ0x3903B3C2)дļУֵɴ˱ó
+ */
+const uint32_t kLegacyTable[256] = {
+	0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,
+	0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
+	0x1DB71064,0x6AB020F2,0xF3B97148,0x84BE41DE,0x1ADAD47D,0x6DDDE4EB,0xF4D4B551,0x83D385C7,
+	0x136C9856,0x646BA8C0,0xFD62F97A,0x8A65C9EC,0x14015C4F,0x63066CD9,0xFA0F3D63,0x8D080DF5,
+	0x3B6E20C8,0x4C69105E,0xD56041E4,0xA2677172,0x3C03E4D1,0x4B04D447,0xD20D85FD,0xA50AB56B,
+	0x35B5A8FA,0x42B2986C,0xDBBBC9D6,0xACBCF940,0x32D86CE3,0x45DF5C75,0xDCD60DCF,0xABD13D59,
+	0x26D930AC,0x51DE003A,0xC8D75180,0xBFD06116,0x21B4F4B5,0x56B3C423,0xCFBA9599,0xB8BDA50F,
+	0x2802B89E,0x5F058808,0xC60CD9B2,0xB10BE924,0x2F6F7C87,0x58684C11,0xC1611DAB,0xB6662D3D,
+	0x76DC4190,0x01DB7106,0x98D220BC,0xEFD5102A,0x71B18589,0x06B6B51F,0x9FBFE4A5,0xE8B8D433,
+	0x7807C9A2,0x0F00F934,0x9609A88E,0xE10E9818,0x7F6A0DBB,0x086D3D2D,0x91646C97,0xE6635C01,
+	0x6B6B51F4,0x1C6C6162,0x856530D8,0xF262004E,0x6C0695ED,0x1B01A57B,0x8208F4C1,0xF50FC457,
+	0x65B0D9C6,0x12B7E950,0x8BBEB8EA,0xFCB9887C,0x62DD1DDF,0x15DA2D49,0x8CD37CF3,0xFBD44C65,
+	0x4DB26158,0x3AB551CE,0xA3BC0074,0xD4BB30E2,0x4ADFA541,0x3DD895D7,0xA4D1C46D,0xD3D6F4FB,
+	0x4369E96A,0x346ED9FC,0xAD678846,0xDA60B8D0,0x44042D73,0x33031DE5,0xAA0A4C5F,0xDD0D7CC9,
+	0x5005713C,0x270241AA,0xBE0B1010,0xC90C2086,0x5768B525,0x206F85B3,0xB966D409,0xCE61E49F,
+	0x5EDEF90E,0x29D9C998,0xB0D09822,0xC7D7A8B4,0x59B33D17,0x2EB40D81,0xB7BD5C3B,0xC0BA6CAD,
+	0xEDB88320,0x9ABFB3B6,0x03B6E20C,0x74B1D29A,0xEAD54739,0x9DD277AF,0x04DB2615,0x73DC1683,
+	0xE3630B12,0x94643B84,0x0D6D6A3E,0x7A6A5AA8,0xE40ECF0B,0x9309FF9D,0x0A00AE27,0x7D079EB1,
+	0xF00F9344,0x8708A3D2,0x1E01F268,0x6906C2FE,0xF762575D,0x806567CB,0x196C3671,0x6E6B06E7,
+	0xFED41B76,0x89D32BE0,0x10DA7A5A,0x67DD4ACC,0xF9B9DF6F,0x8EBEEFF9,0x17B7BE43,0x60B08ED5,
+	0xD6D6A3E8,0xA1D1937E,0x38D8C2C4,0x4FDFF252,0xD1BB67F1,0xA6BC5767,0x3FB506DD,0x48B2364B,
+	0xD80D2BDA,0xAF0A1B4C,0x36034AF6,0x41047A60,0xDF60EFC3,0xA867DF55,0x316E8EEF,0x4669BE79,
+	0xCB61B38C,0xBC66831A,0x256FD2A0,0x5268E236,0xCC0C7795,0xBB0B4703,0x220216B9,0x5505262F,
+	0xC5BA3BBE,0xB2BD0B28,0x2BB45A92,0x5CB36A04,0xC2D7FFA7,0xB5D0CF31,0x2CD99E8B,0x5BDEAE1D,
+	0x9B64C2B0,0xEC63F226,0x756AA39C,0x026D930A,0x9C0906A9,0xEB0E363F,0x72076785,0x05005713,
+	0x95BF4A82,0xE2B87A14,0x7BB12BAE,0x0CB61B38,0x92D28E9B,0xE5D5BE0D,0x7CDCEFB7,0x0BDBDF21,
+	0x86D3D2D4,0xF1D4E242,0x68DDB3F8,0x1FDA836E,0x81BE16CD,0xF6B9265B,0x6FB077E1,0x18B74777,
+	0x88085AE6,0xFF0F6A70,0x66063BCA,0x11010B5C,0x8F659EFF,0xF862AE69,0x616BFFD3,0x166CCF45,
+	0xA00AE278,0xD70DD2EE,0x4E048354,0x3903C2,0xA7672661,0xD06016F7,0x4969474D,0x3E6E77DB,
+	0xAED16A4A,0xD9D65ADC,0x40DF0B66,0x37D83BF0,0xA9BCAE53,0xDEBB9EC5,0x47B2CF7F,0x30B5FFE9,
+	0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,
+	0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D
+};
+
+const uint32_t kPolyCrc32 = 0xEDB88320u;  ///< ׼CRC-32ʽ(λת)
+const uint32_t kPolyCrc32c = 0x82F63B78u; ///< CRC-32Cʽ(λת)
+
+/**
+ * @struct SliceTables
+ * @brief slicing-by-8
+ *
+ * table[0]Ϊֽͨڲtable[k][b]Ϊֽb֮پkֽڵʽ
+ * 8ֽڵĹ׿Էֱϲ
+ */
+struct SliceTables {
+	uint32_t table[8][256];
+
+	explicit SliceTables(uint32_t poly)
+	{
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (c >> 1) ^ poly : (c >> 1);
+			}
+			table[0][i] = c;
+		}
+		for (uint32_t i = 0; i < 256; ++i) {
+			for (int k = 1; k < 8; ++k) {
+				uint32_t prev = table[k - 1][i];
+				table[k][i] = (prev >> 8) ^ table[0][prev & 0xFF];
+			}
+		}
+	}
+};
+
+/**
+ * @brief ȡУ㷨ӦĲ
+ * @param[in] type У㷨(CHECKSUM_CRC32CHECKSUM_CRC32C)
+ */
+const SliceTables& sliceTables(ChecksumType type)
+{
+	static const SliceTables crc32(kPolyCrc32);
+	static const SliceTables crc32c(kPolyCrc32c);
+	return (type == CHECKSUM_CRC32C) ? crc32c : crc32;
+}
+
+/**
+ * @brief Сȡ32λ
+ */
+inline uint32_t load32(const unsigned char* p)
+{
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+		(static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/**
+ * @brief ֽڲ
+ * @param[in] table 256
+ * @param[in] crc ڲ״̬
+ * @param[in] p 
+ * @param[in] n ݳ
+ * @return µڲ״̬
+ */
+uint32_t updateTable(const uint32_t* table, uint32_t crc, const unsigned char* p, size_t n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		crc = (crc >> 8) ^ table[(crc ^ p[i]) & 0xFF];
+	}
+	return crc;
+}
+
+/**
+ * @brief slicing-by-8ÿδ8ֽ
+ * @param[in] t 
+ * @param[in] crc ڲ״̬
+ * @param[in] p 
+ * @param[in] n ݳ
+ * @return µڲ״̬
+ */
+uint32_t updateSlice8(const SliceTables& t, uint32_t crc, const unsigned char* p, size_t n)
+{
+	while (n >= 8) {
+		uint32_t lo = load32(p) ^ crc;
+		uint32_t hi = load32(p + 4);
+		crc = t.table[7][lo & 0xFF] ^ t.table[6][(lo >> 8) & 0xFF] ^
+			t.table[5][(lo >> 16) & 0xFF] ^ t.table[4][lo >> 24] ^
+			t.table[3][hi & 0xFF] ^ t.table[2][(hi >> 8) & 0xFF] ^
+			t.table[1][(hi >> 16) & 0xFF] ^ t.table[0][hi >> 24];
+		p += 8;
+		n -= 8;
+	}
+	return updateTable(t.table[0], crc, p, n);
+}
+
+#ifdef STEGO_X86
+
+/**
+ * @brief ʹSSE4.2 crc32ָCRC-32C
+ * @param[in] crc ڲ״̬
+ * @param[in] p 
+ * @param[in] n ݳ
+ * @return µڲ״̬
+ */
+STEGO_TARGET("sse4.2")
+uint32_t updateCrc32cHw(uint32_t crc, const unsigned char* p, size_t n)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+	uint64_t state = crc;
+	while (n >= 8) {
+		uint64_t v = static_cast<uint64_t>(load32(p)) | (static_cast<uint64_t>(load32(p + 4)) << 32);
+		state = _mm_crc32_u64(state, v);
+		p += 8;
+		n -= 8;
+	}
+	crc = static_cast<uint32_t>(state);
+#endif
+	while (n >= 4) {
+		crc = _mm_crc32_u32(crc, load32(p));
+		p += 4;
+		n -= 4;
+	}
+	while (n > 0) {
+		crc = _mm_crc32_u8(crc, *p++);
+		--n;
+	}
+	return crc;
+}
+
+/**
+ * @brief ʹPCLMULQDQ۵׼CRC-32
+ * @param[in] crc ڲ״̬
+ * @param[in] p 
+ * @param[in] n ݳȣ64ֽΪ16ı
+ * @return µڲ״̬
+ */
+STEGO_TARGET("sse4.1,pclmul")
+uint32_t foldCrc32Pclmul(uint32_t crc, const unsigned char* p, size_t n)
+{
+	static const uint64_t k1k2[2] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+	static const uint64_t k3k4[2] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+	static const uint64_t k5k0[2] = { 0x0163cd6124ULL, 0x0000000000ULL };
+	static const uint64_t poly[2] = { 0x01db710641ULL, 0x01f7011641ULL };
+
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+	// ׸64ֽڿ鲢ʼ״̬
+	x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+	x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+	x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+	x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k1k2));
+	p += 64;
+	n -= 64;
+
+	// ·۵64ֽڿ
+	while (n >= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+		y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+		y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+		y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+		y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+		p += 64;
+		n -= 64;
+	}
+
+	// ·ϲΪ128λ
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// ۵ʣ16ֽڿ
+	while (n >= 16) {
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		p += 16;
+		n -= 16;
+	}
+
+	// 128λ۵Ϊ64λ
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k5k0));
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// BarrettԼΪ32λ
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(poly));
+
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+/**
+ * @brief ʹPCLMULQDQ׼CRC-32һ۵Ĳslicing-by-8
+ * @param[in] crc ڲ״̬
+ * @param[in] p 
+ * @param[in] n ݳ
+ * @return µڲ״̬
+ */
+uint32_t updateCrc32Hw(uint32_t crc, const unsigned char* p, size_t n)
+{
+	if (n >= 64) {
+		size_t chunk = n & ~static_cast<size_t>(15);
+		crc = foldCrc32Pclmul(crc, p, chunk);
+		p += chunk;
+		n -= chunk;
+	}
+	return updateSlice8(sliceTables(CHECKSUM_CRC32), crc, p, n);
+}
+
+#endif // STEGO_X86
+
+/**
+ * @brief ⵱ǰCPUĳһУ㷨ʵ
+ * @param[in] type У㷨
+ * @return õʵ
+ */
+CrcEngine detectBestEngine(ChecksumType type)
+{
+	const CpuFeatures& cpu = cpuFeatures();
+	if (type == CHECKSUM_CRC32 && cpu.pclmul && cpu.sse41) return CRC_ENGINE_HW;
+	if (type == CHECKSUM_CRC32C && cpu.sse42) return CRC_ENGINE_HW;
+	return CRC_ENGINE_SLICE8;
+}
+
+} // namespace
+
+/**
+ * @brief ʵͽΪǰCPUʵʹõʵ
+ *
+ * ʵͰУʵֲʱ˵õʵ֡
+ * ԭвCRC32ֻֽʵ֡
+ *
+ * @param[in] type У㷨
+ * @param[in] engine ʵ
+ * @return ʵʹõʵ
+ */
+CrcEngine crcResolveEngine(ChecksumType type, CrcEngine engine)
+{
+	static const CrcEngine bestCrc32 = detectBestEngine(CHECKSUM_CRC32);
+	static const CrcEngine bestCrc32c = detectBestEngine(CHECKSUM_CRC32C);
+
+	if (type != CHECKSUM_CRC32 && type != CHECKSUM_CRC32C) return CRC_ENGINE_TABLE;
+	CrcEngine best = (type == CHECKSUM_CRC32C) ? bestCrc32c : bestCrc32;
+	if (engine == CRC_ENGINE_AUTO || engine > best) return best;
+	return engine;
+}
+
+/**
+ * @brief ݵУֵ
+ *
+ * @param[in] type У㷨
+ * @param[in] crc һεУֵ׶Ϊ0
+ * @param[in] data 
+ * @param[in] length ݳ(ֽ)
+ * @param[in] engine ʵ
+ * @return εУֵ
+ */
+uint32_t checksumUpdate(ChecksumType type, uint32_t crc, const void* data, size_t length, CrcEngine engine)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	uint32_t state = ~crc;
+
+	if (type != CHECKSUM_CRC32 && type != CHECKSUM_CRC32C) {
+		return ~updateTable(kLegacyTable, state, p, length);
+	}
+
+	switch (crcResolveEngine(type, engine)) {
+#ifdef STEGO_X86
+	case CRC_ENGINE_HW:
+		state = (type == CHECKSUM_CRC32C) ? updateCrc32cHw(state, p, length) : updateCrc32Hw(state, p, length);
+		break;
+#endif
+	case CRC_ENGINE_TABLE:
+		state = updateTable(sliceTables(type).table[0], state, p, length);
+		break;
+	default:
+		state = updateSlice8(sliceTables(type), state, p, length);
+		break;
+	}
+	return ~state;
+}
+
+/**
+ * @brief ȡУ㷨
+ * @param[in] type У㷨
+ * @return ַ
+ */
+const char* checksumName(ChecksumType type)
+{
+	switch (type) {
+	case CHECKSUM_LEGACY: return "legacy";
+	case CHECKSUM_CRC32:  return "crc32";
+	case CHECKSUM_CRC32C: return "crc32c";
+	}
+	return "unknown";
+}
+
+/**
+ * @brief ȡʵ
+ * @param[in] engine ʵ
+ * @return ַ
+ */
+const char* crcEngineName(CrcEngine engine)
+{
+	switch (engine) {
+	case CRC_ENGINE_AUTO:   return "auto";
+	case CRC_ENGINE_TABLE:  return "table";
+	case CRC_ENGINE_SLICE8: return "slice8";
+	case CRC_ENGINE_HW:     return "hw";
+	}
+	return "unknown";
+}
@@ -0,0 +1,83 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Crc32.h
+ * @brief Уֵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ṩУ㷨
+ * - ԭвCRC32ɰ汾дУֵһ£֤ļ
+ * - ׼CRC-32(ʽ0xEDB88320zlibһ)slicing-by-8PCLMULQDQ۵
+ * - CRC-32C(ʽ0x82F63B78)slicing-by-8SSE4.2 crc32ָ
+ *
+ * кɷֶۼӣһεķֵΪһεĳʼֵ(׶δ0)
+ * һμͬ
+ */
+
+ /**
+  * @enum ChecksumType
+  * @brief У㷨
+  *
+  * ԭвCRC32Ԥ0xE3׼CRC-32ͬ(0x003903C2׼ֵΪ0x3903B3C2)
+  * CRCʣ޷ʹðֽڲе㷨ֻֽڲ
+  * Ϊ֤ļȡ㷨ԭдĬʹñ׼CRC-32
+  */
+enum ChecksumType : uint16_t {
+	CHECKSUM_LEGACY = 0, ///< ԭвCRC32(ֽ)
+	CHECKSUM_CRC32 = 1,  ///< ׼CRC-32
+	CHECKSUM_CRC32C = 2  ///< CRC-32C(Castagnoli)
+};
+
+/**
+ * @enum CrcEngine
+ * @brief Уʵ
+ *
+ * ָԱA/BԱȣָʵڵǰCPUϲʱԶˡ
+ * ԭвCRC32ʼֽڼ㣬ܴ˲Ӱ졣
+ */
+enum CrcEngine : uint16_t {
+	CRC_ENGINE_AUTO = 0,   ///< ʱԶѡǰCPUֵ֧ʵ
+	CRC_ENGINE_TABLE = 1,  ///< ֽڲ(οʵ)
+	CRC_ENGINE_SLICE8 = 2, ///< slicing-by-8ÿδ8ֽ
+	CRC_ENGINE_HW = 3      ///< Ӳָ(CRC-32PCLMULQDQCRC-32CSSE4.2)
+};
+
+/**
+ * @brief ݵУֵ
+ * @param[in] type У㷨
+ * @param[in] crc һεУֵ׶Ϊ0
+ * @param[in] data 
+ * @param[in] length ݳ(ֽ)
+ * @param[in] engine ʵ
+ * @return εУֵ
+ */
+uint32_t checksumUpdate(ChecksumType type, uint32_t crc, const void* data, size_t length,
+	CrcEngine engine = CRC_ENGINE_AUTO);
+
+/**
+ * @brief ʵͽΪǰCPUʵʹõʵ
+ * @param[in] type У㷨
+ * @param[in] engine ʵ
+ * @return ʵʹõʵ(᷵CRC_ENGINE_AUTO)
+ */
+CrcEngine crcResolveEngine(ChecksumType type, CrcEngine engine);
+
+/**
+ * @brief ȡУ㷨
+ * @param[in] type У㷨
+ * @return ַ"crc32""crc32c"
+ */
+const char* checksumName(ChecksumType type);
+
+/**
+ * @brief ȡʵ
+ * @param[in] engine ʵ
+ * @return ַ"table""slice8""hw"
+ */
+const char* crcEngineName(CrcEngine engine);
+
+#endif // CRC32_H
@@ -0,0 +1,213 @@
+#include "FileSystem.h"
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif defined(__APPLE__)
+#include <sys/clonefile.h>
+#endif
+#endif
+
+/**
+ * @file FileSystem.cpp
+ * @brief ƽ̨Ŀ¼ļʵ
+ * @copyright Copyright 2025, Ϣص6
+ */
+
+using namespace std;
+
+/**
+ * @brief жļǷָչβ(ִСд)
+ * @param[in] name ļ
+ * @param[in] extension չΪʱƥ
+ * @return ƥ䷵true
+ */
+static bool hasExtension(const string& name, const string& extension)
+{
+	if (extension.empty()) return true;
+	if (name.size() <= extension.size()) return false;
+	return equal(extension.begin(), extension.end(), name.end() - extension.size(),
+		[](char a, char b) {
+			return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b));
+		});
+}
+
+/**
+ * @brief гĿ¼չƥͨļ
+ *
+ * Ŀ¼·ĩβûзָʱ'/'ƴļ(Windowsͬ'/')
+ * ֵУʹ˳ļϵͳö˳޹ء
+ *
+ * @param[in] directory Ŀ¼·
+ * @param[in] extension չ
+ * @param[out] paths ļ·
+ * @return ɹtrue
+ */
+bool listDirectory(const std::string& directory, const std::string& extension, std::vector<std::string>& paths)
+{
+	paths.clear();
+	string prefix = directory;
+	if (!prefix.empty() && prefix.back() != '/' && prefix.back() != '\\') prefix += '/';
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((prefix + "*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE) {
+		cerr << "[] ޷Ŀ¼: " << directory << endl;
+		return false;
+	}
+	do {
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+		if (hasExtension(data.cFileName, extension)) paths.push_back(prefix + data.cFileName);
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (!dir) {
+		cerr << "[] ޷Ŀ¼: " << directory << endl;
+		return false;
+	}
+	while (dirent* entry = readdir(dir)) {
+		string name = entry->d_name;
+		if (!hasExtension(name, extension)) continue;
+		struct stat st;
+		string path = prefix + name;
+		if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) paths.push_back(path);
+	}
+	closedir(dir);
+#endif
+
+	sort(paths.begin(), paths.end());
+	return true;
+}
+
+/**
+ * @brief ж·ǷΪѴڵĿ¼
+ * @param[in] path ·
+ * @return Ŀ¼true
+ */
+bool isDirectory(const std::string& path)
+{
+#ifdef _WIN32
+	DWORD attributes = GetFileAttributesA(path.c_str());
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/**
+ * @brief ȡͨļĴС޸ʱ
+ *
+ * ޸ʱWindowsΪFILETIME(100)ƽ̨Ϊ(st_mtimʱΪ)
+ *
+ * @param[in] path ļ·
+ * @param[out] stamp С޸ʱ
+ * @return ɹtrue
+ */
+bool fileStamp(const std::string& path, FileStamp& stamp)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data) ||
+		(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		return false;
+	}
+	stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	stamp.mtime = static_cast<int64_t>((static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+		data.ftLastWriteTime.dwLowDateTime);
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+	stamp.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+	stamp.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L
+	stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	stamp.mtime = static_cast<int64_t>(st.st_mtime);
+#endif
+#endif
+	return true;
+}
+
+/**
+ * @brief ж·Ƿָͬһļ
+ * @param[in] a ·
+ * @param[in] b ·
+ * @return ͬһļtrue
+ */
+bool sameFile(const std::string& a, const std::string& b)
+{
+#ifdef _WIN32
+	auto identify = [](const string& path, BY_HANDLE_FILE_INFORMATION& info) {
+		HANDLE file = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		bool ok = GetFileInformationByHandle(file, &info) != 0;
+		CloseHandle(file);
+		return ok;
+	};
+	BY_HANDLE_FILE_INFORMATION x, y;
+	return identify(a, x) && identify(b, y) &&
+		x.dwVolumeSerialNumber == y.dwVolumeSerialNumber &&
+		x.nFileIndexHigh == y.nFileIndexHigh &&
+		x.nFileIndexLow == y.nFileIndexLow;
+#else
+	struct stat x, y;
+	if (stat(a.c_str(), &x) != 0 || stat(b.c_str(), &y) != 0) return false;
+	return x.st_dev == y.st_dev && x.st_ino == y.st_ino;
+#endif
+}
+
+/**
+ * @brief Թݿķʽļ(reflink)
+ *
+ * Linux¶½ĿļFICLONE(btrfsXFS֧)macOSµclonefile(APFS)
+ * ֻݿãдļݡƽ̨Ƿfalse
+ *
+ * @param[in] source Դļ
+ * @param[in] target Ŀļ
+ * @return ɹtrue
+ */
+bool reflinkFile(const std::string& source, const std::string& target)
+{
+	if (sameFile(source, target)) return false;
+#if defined(__linux__) && defined(FICLONE)
+	int src = ::open(source.c_str(), O_RDONLY);
+	if (src < 0) return false;
+	struct stat st;
+	if (fstat(src, &st) != 0) {
+		::close(src);
+		return false;
+	}
+	int dst = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC, st.st_mode & 0777);
+	if (dst < 0) {
+		::close(src);
+		return false;
+	}
+	bool ok = ioctl(dst, FICLONE, src) == 0;
+	::close(dst);
+	::close(src);
+	return ok;
+#elif defined(__APPLE__)
+	unlink(target.c_str());
+	return clonefile(source.c_str(), target.c_str(), 0) == 0;
+#else
+	return false;
+#endif
+}
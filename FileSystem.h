@@ -0,0 +1,71 @@
+#ifndef FILE_SYSTEM_H
+#define FILE_SYSTEM_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @file FileSystem.h
+ * @brief ƽ̨Ŀ¼ļ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * WindowsʹFindFirstFile/FindNextFileGetFileAttributesExƽ̨ʹopendir/readdirstat
+ */
+
+/**
+ * @struct FileStamp
+ * @brief ļС޸ʱ䣬жϻļǷȻЧ
+ */
+struct FileStamp {
+	uint64_t size = 0;  ///< ļС(ֽ)
+	int64_t  mtime = 0; ///< ޸ʱ(ƽ̨صλȱȽ)
+
+	bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+	bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief гĿ¼չƥͨļ
+ * @param[in] directory Ŀ¼·
+ * @param[in] extension չ(ţ".bmp")ִСдΪʱгȫͨļ
+ * @param[out] paths ļ·(Ŀ¼·ļƴ)ֵ
+ * @return ɹtrueĿ¼޷ʱfalse
+ * @note ݹĿ¼
+ */
+bool listDirectory(const std::string& directory, const std::string& extension, std::vector<std::string>& paths);
+
+/**
+ * @brief ж·ǷΪѴڵĿ¼
+ * @param[in] path ·
+ * @return Ŀ¼true
+ */
+bool isDirectory(const std::string& path);
+
+/**
+ * @brief ȡͨļĴС޸ʱ
+ * @param[in] path ļ·
+ * @param[out] stamp С޸ʱ
+ * @return ļΪͨļʱtrue
+ */
+bool fileStamp(const std::string& path, FileStamp& stamp);
+
+/**
+ * @brief ж·Ƿָͬһļ
+ * @param[in] a ·
+ * @param[in] b ·
+ * @return ߾ļʶ(豸/ڵк/ļ)ͬʱtrue
+ */
+bool sameFile(const std::string& a, const std::string& b);
+
+/**
+ * @brief Թݿķʽļ(reflink)
+ * @param[in] source Դļ
+ * @param[in] target ĿļѴʱ滻
+ * @return ļϵͳ֧ҸƳɹʱtrue
+ * @note ֧ʱ(ext4NTFS)falseҲ󣬵Ӧͨд
+ *       Ŀļѱض
+ */
+bool reflinkFile(const std::string& source, const std::string& target);
+
+#endif // FILE_SYSTEM_H
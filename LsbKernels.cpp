@@ -0,0 +1,963 @@
+#include "LsbKernels.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+
+/**
+ * @file LsbKernels.cpp
+ * @brief ˳LSBǶ/ȡںʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ں˵Ļ˼·
+ * 1. ȡֽ7λmovemaskһȡ16/32ֽڵλ
+ *    ͨѹλ(pext)ۻֽڷתλ
+ * 2. Ƕ룺ȡֽͬλͨչ(pdep)
+ *    㲥ֽڵ0/1λ
+ * 3. 2λģʽֽڵĵ1λ0λλԣΪλӱ1λ崦
+ *    ǶʱλϲΪ2λֵд
+ * ͨĿֽͼlcm(ͨ, )ΪڣԤȼ㡣
+ * һʼβʹصƫʵһ¡
+ */
+
+using namespace std;
+
+namespace {
+
+/// λڸֵʱֱʹñʵ(16ֽͷ)׼Ŀ
+const size_t kSimdMinBits = 512;
+
+/**
+ * @brief ȡֽλת
+ * @return 256תtable[v]Ϊv8λ
+ */
+const unsigned char* reverseTable()
+{
+	static unsigned char table[256];
+	static const bool ready = []() {
+		for (int v = 0; v < 256; ++v) {
+			unsigned char r = 0;
+			for (int b = 0; b < 8; ++b) {
+				if (v & (1 << b)) r |= static_cast<unsigned char>(0x80 >> b);
+			}
+			table[v] = r;
+		}
+		return true;
+	}();
+	(void)ready;
+	return table;
+}
+
+/* ---------------------------------------------------------------------------
+ * οʵ
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief λǶ
+ *
+ * ԭ˳LSBд㷨λһ£ֽжֽͨռbitsPerChannelλ
+ * (ݲʱֻռʣλ)дλ
+ */
+size_t embedScalar(unsigned char* carrier, size_t carrierSize, size_t& pos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+{
+	size_t done = 0;
+	while (done < numBits && pos < carrierSize) {
+		int ch = static_cast<int>(pos % p.channels);
+		if ((p.channelMask >> ch) & 0x01) {
+			unsigned char bits = 0;
+			for (int i = 0; i < p.bitsPerChannel && done < numBits; ++i) {
+				size_t b = srcBit + done;
+				bits = static_cast<unsigned char>((bits << 1) | ((src[b >> 3] >> (7 - (b & 7))) & 0x01));
+				++done;
+			}
+			if (p.bitsPerChannel == 1) {
+				carrier[pos] = static_cast<unsigned char>((carrier[pos] & 0xFE) | (bits & 0x01));
+			}
+			else {
+				carrier[pos] = static_cast<unsigned char>((carrier[pos] & 0xFC) | (bits & 0x03));
+			}
+		}
+		++pos;
+	}
+	return done;
+}
+
+/**
+ * @brief λȡ
+ */
+size_t extractScalar(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+{
+	size_t done = 0;
+	unsigned char valueMask = (p.bitsPerChannel == 1) ? 0x01 : 0x03;
+	while (done < numBits && pos < carrierSize) {
+		int ch = static_cast<int>(pos % p.channels);
+		if ((p.channelMask >> ch) & 0x01) {
+			unsigned char val = carrier[pos] & valueMask;
+			for (int i = p.bitsPerChannel - 1; i >= 0 && done < numBits; --i) {
+				size_t b = dstBit + done;
+				unsigned char bit = static_cast<unsigned char>(0x80 >> (b & 7));
+				if ((val >> i) & 0x01) dst[b >> 3] |= bit;
+				else dst[b >> 3] &= static_cast<unsigned char>(~bit);
+				++done;
+			}
+		}
+		++pos;
+	}
+	return done;
+}
+
+/**
+ * @struct MsbBitReader
+ * @brief λǰ˳ζȡλ
+ */
+struct MsbBitReader {
+	const unsigned char* src;
+	size_t   inByte;
+	uint32_t acc;
+	int      accBits;
+
+	MsbBitReader(const unsigned char* in, size_t bitPos)
+		: src(in), inByte(bitPos >> 3), acc(0), accBits(0)
+	{
+		int r = static_cast<int>(bitPos & 7);
+		acc = src[inByte++] & (0xFFu >> r);
+		accBits = 8 - r;
+	}
+
+	inline unsigned take(int n)
+	{
+		if (accBits < n) {
+			acc = ((acc << 8) | src[inByte++]) & 0xFFFFu;
+			accBits += 8;
+		}
+		accBits -= n;
+		return (acc >> accBits) & ((1u << n) - 1);
+	}
+};
+
+/**
+ * @struct MsbBitWriter
+ * @brief λǰ˳дλ
+ *
+ * ʼλֽڱ߽ʱĿֽеλ
+ */
+struct MsbBitWriter {
+	unsigned char* dst;
+	size_t   outByte;
+	uint32_t acc;
+	int      accBits;
+
+	MsbBitWriter(unsigned char* out, size_t bitPos)
+		: dst(out), outByte(bitPos >> 3), acc(0), accBits(static_cast<int>(bitPos & 7))
+	{
+		if (accBits) acc = dst[outByte] >> (8 - accBits);
+	}
+
+	inline void put(unsigned bits, int n)
+	{
+		acc = (acc << n) | bits;
+		accBits += n;
+		if (accBits >= 8) {
+			accBits -= 8;
+			dst[outByte++] = static_cast<unsigned char>(acc >> accBits);
+			acc &= (1u << accBits) - 1;
+		}
+	}
+
+	void finish()
+	{
+		if (accBits == 0) return;
+		unsigned char keep = static_cast<unsigned char>(0xFF >> accBits);
+		dst[outByte] = static_cast<unsigned char>((acc << (8 - accBits)) | (dst[outByte] & keep));
+	}
+};
+
+/**
+ * @struct ScalarKernel
+ * @brief (ͨ, ͨ, ÿͨλ)ػıں
+ *
+ * ͨʵִر߽磬شͨжڱչ
+ * ڲѭȡģ֧һͨʵ֣Ա֤ƫһ¡
+ */
+template <int C, int MASK, int BITS>
+struct ScalarKernel {
+	static const int kBitsPerPixel =
+		(((MASK >> 0) & 1) + ((MASK >> 1) & 1) + ((MASK >> 2) & 1) + ((MASK >> 3) & 1)) * BITS;
+	static const unsigned char kClear = static_cast<unsigned char>(0xFF << BITS);
+
+	static size_t embed(unsigned char* carrier, size_t carrierSize, size_t& pos,
+		const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+	{
+		size_t head = (C - pos % C) % C;
+		size_t done = embedScalar(carrier, min(carrierSize, pos + head), pos, src, srcBit, numBits, p);
+		if (done == numBits || pos >= carrierSize) return done;
+
+		size_t pixels = min((carrierSize - pos) / C, (numBits - done - 1) / kBitsPerPixel);
+		if (pixels > 0) {
+			MsbBitReader in(src, srcBit + done);
+			unsigned char* px = carrier + pos;
+			for (size_t i = 0; i < pixels; ++i, px += C) {
+				for (int ch = 0; ch < C; ++ch) {
+					if ((MASK >> ch) & 1) {
+						px[ch] = static_cast<unsigned char>((px[ch] & kClear) | in.take(BITS));
+					}
+				}
+			}
+			pos += pixels * C;
+			done += pixels * kBitsPerPixel;
+		}
+
+		done += embedScalar(carrier, carrierSize, pos, src, srcBit + done, numBits - done, p);
+		return done;
+	}
+
+	static size_t extract(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+		unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+	{
+		size_t head = (C - pos % C) % C;
+		size_t done = extractScalar(carrier, min(carrierSize, pos + head), pos, dst, dstBit, numBits, p);
+		if (done == numBits || pos >= carrierSize) return done;
+
+		size_t pixels = min((carrierSize - pos) / C, (numBits - done - 1) / kBitsPerPixel);
+		if (pixels > 0) {
+			MsbBitWriter out(dst, dstBit + done);
+			const unsigned char* px = carrier + pos;
+			for (size_t i = 0; i < pixels; ++i, px += C) {
+				for (int ch = 0; ch < C; ++ch) {
+					if ((MASK >> ch) & 1) {
+						out.put(px[ch] & ((1u << BITS) - 1), BITS);
+					}
+				}
+			}
+			out.finish();
+			pos += pixels * C;
+			done += pixels * kBitsPerPixel;
+		}
+
+		done += extractScalar(carrier, carrierSize, pos, dst, dstBit + done, numBits - done, p);
+		return done;
+	}
+};
+
+#ifdef STEGO_X86
+
+/* ---------------------------------------------------------------------------
+ * 
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @struct SoftBitTables
+ * @brief ֽڵpext/pdepұ(SSE2·ʹ)
+ */
+struct SoftBitTables {
+	unsigned char compact[256][256]; ///< compact[m][v]mѹvλ
+	unsigned char deposit[256][256]; ///< deposit[m][v]vĵλչmλ
+	unsigned char popcount[256];     ///< λ
+};
+
+/**
+ * @brief ȡpext/pdepұ
+ */
+const SoftBitTables& softBitTables()
+{
+	static SoftBitTables tables;
+	static const bool ready = []() {
+		for (unsigned m = 0; m < 256; ++m) {
+			int cnt = 0;
+			for (int b = 0; b < 8; ++b) cnt += (m >> b) & 1;
+			tables.popcount[m] = static_cast<unsigned char>(cnt);
+			for (unsigned v = 0; v < 256; ++v) {
+				unsigned packed = 0, spread = 0;
+				int idx = 0;
+				for (int b = 0; b < 8; ++b) {
+					if (!((m >> b) & 1)) continue;
+					packed |= ((v >> b) & 1u) << idx;
+					spread |= ((v >> idx) & 1u) << b;
+					++idx;
+				}
+				tables.compact[m][v] = static_cast<unsigned char>(packed);
+				tables.deposit[m][v] = static_cast<unsigned char>(spread);
+			}
+		}
+		return true;
+	}();
+	(void)ready;
+	return tables;
+}
+
+/**
+ * @brief pextѹbytesֽеλ
+ */
+inline uint32_t softCompact(const SoftBitTables& t, uint32_t bits, uint32_t mask, int bytes)
+{
+	uint32_t out = 0;
+	int shift = 0;
+	for (int i = 0; i < bytes; ++i) {
+		unsigned mb = (mask >> (8 * i)) & 0xFF;
+		out |= static_cast<uint32_t>(t.compact[mb][(bits >> (8 * i)) & 0xFF]) << shift;
+		shift += t.popcount[mb];
+	}
+	return out;
+}
+
+/**
+ * @brief pdepλչλ
+ */
+inline uint32_t softDeposit(const SoftBitTables& t, uint32_t bits, uint32_t mask, int bytes)
+{
+	uint32_t out = 0;
+	for (int i = 0; i < bytes; ++i) {
+		unsigned mb = (mask >> (8 * i)) & 0xFF;
+		int cnt = t.popcount[mb];
+		out |= static_cast<uint32_t>(t.deposit[mb][bits & ((1u << cnt) - 1)]) << (8 * i);
+		bits >>= cnt;
+	}
+	return out;
+}
+
+/**
+ * @struct VectorPattern
+ * @brief һڸĿλͼ
+ *
+ * 3ͨʱΪ3(4896ֽ)4ͨʱΪ1
+ * 1λģʽÿһλͼjλӦjֽڣ
+ * 2λģʽÿÿǰλͼ2j/2j+1λӦðеjֽڵĸ/λ
+ */
+struct VectorPattern {
+	int      vectors = 1;            ///< ÿ
+	int      steps = 1;              ///< ÿĲ(ÿͨλ)
+	uint32_t mask[3][2] = {};        ///< Ŀλͼ
+	int      count[3][2] = {};       ///< Ŀλ
+	size_t   total[3] = {};          ///< Ŀλ
+	unsigned char clear[3][32];      ///< (ֽΪ0xFE/0xFCΪ0xFF)
+};
+
+/**
+ * @brief ͼ
+ * @param[in] p ʹģʽ
+ * @param[in] width (1632ֽ)
+ * @return ͼ
+ */
+VectorPattern buildPattern(const LsbPattern& p, int width)
+{
+	VectorPattern vp;
+	vp.vectors = (p.channels == 3) ? 3 : 1;
+	vp.steps = p.bitsPerChannel;
+	int span = width / vp.steps;
+	unsigned char cleared = (p.bitsPerChannel == 1) ? 0xFE : 0xFC;
+	for (int k = 0; k < vp.vectors; ++k) {
+		vp.total[k] = 0;
+		for (int j = 0; j < width; ++j) {
+			bool used = ((p.channelMask >> ((k * width + j) % p.channels)) & 0x01) != 0;
+			vp.clear[k][j] = used ? cleared : 0xFF;
+		}
+		for (int s = 0; s < vp.steps; ++s) {
+			uint32_t m = 0;
+			for (int j = 0; j < span; ++j) {
+				if (vp.clear[k][s * span + j] == 0xFF) continue;
+				m |= (vp.steps == 1) ? (1u << j) : (3u << (2 * j));
+			}
+			int cnt = 0;
+			for (int b = 0; b < 32; ++b) cnt += (m >> b) & 1;
+			vp.mask[k][s] = m;
+			vp.count[k][s] = cnt;
+			vp.total[k] += cnt;
+		}
+	}
+	return vp;
+}
+
+/**
+ * @brief ȡػں˵ͼ״εʱ
+ */
+template <int C, int MASK, int BITS, int WIDTH>
+const VectorPattern& cachedPattern()
+{
+	static const VectorPattern vp = []() {
+		LsbPattern p;
+		p.channels = C;
+		p.channelMask = MASK;
+		p.bitsPerChannel = BITS;
+		return buildPattern(p, WIDTH);
+	}();
+	return vp;
+}
+
+/**
+ * @struct BitSink
+ * @brief ȡλۻ
+ *
+ * LSBۻѹλ8λתλдʹΪλǰ
+ * ʼλֽڱ߽ʱĿֽеĸλ
+ */
+struct BitSink {
+	unsigned char* dst;
+	size_t   outByte;
+	uint64_t acc;
+	int      accBits;
+	const unsigned char* rev;
+
+	BitSink(unsigned char* out, size_t bitPos)
+		: dst(out), outByte(bitPos >> 3), acc(0), accBits(static_cast<int>(bitPos & 7)), rev(reverseTable())
+	{
+		if (accBits) acc = rev[dst[outByte]] & ((1u << accBits) - 1);
+	}
+
+	inline void put(uint32_t bits, int n)
+	{
+		acc |= static_cast<uint64_t>(bits) << accBits;
+		accBits += n;
+		while (accBits >= 8) {
+			dst[outByte++] = rev[acc & 0xFF];
+			acc >>= 8;
+			accBits -= 8;
+		}
+	}
+
+	/// һֽڵʣλдأֽλ
+	void finish()
+	{
+		if (accBits == 0) return;
+		unsigned char keep = static_cast<unsigned char>(0xFF >> accBits);
+		dst[outByte] = static_cast<unsigned char>((dst[outByte] & keep) | (rev[acc & 0xFF] & ~keep));
+	}
+};
+
+/**
+ * @struct BitSource
+ * @brief Ƕλȡ
+ *
+ * ԴֽڲתλʹLSBȡ
+ * ֻδλʱһֽڣԽԴĩβ
+ */
+struct BitSource {
+	const unsigned char* src;
+	size_t   inByte;
+	uint64_t acc;
+	int      accBits;
+	const unsigned char* rev;
+
+	BitSource(const unsigned char* in, size_t bitPos)
+		: src(in), inByte(bitPos >> 3), acc(0), accBits(0), rev(reverseTable())
+	{
+		int r = static_cast<int>(bitPos & 7);
+		if (r) {
+			acc = rev[src[inByte++]] >> r;
+			accBits = 8 - r;
+		}
+	}
+
+	inline uint32_t take(int n)
+	{
+		while (accBits < n) {
+			acc |= static_cast<uint64_t>(rev[src[inByte++]]) << accBits;
+			accBits += 8;
+		}
+		uint32_t bits = static_cast<uint32_t>(acc & ((1ULL << n) - 1));
+		acc >>= n;
+		accBits -= n;
+		return bits;
+	}
+};
+
+/* ---------------------------------------------------------------------------
+ * SSE2ں
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief 16λչΪ160x00/0x01ֽ
+ */
+STEGO_TARGET("sse2")
+inline __m128i expand16(uint32_t d)
+{
+	const __m128i sel = _mm_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+	uint64_t lo = (d & 0xFF) * 0x0101010101010101ULL;
+	uint64_t hi = ((d >> 8) & 0xFF) * 0x0101010101010101ULL;
+	__m128i b = _mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo));
+	b = _mm_cmpeq_epi8(_mm_and_si128(b, sel), sel);
+	return _mm_and_si128(b, _mm_set1_epi8(1));
+}
+
+/**
+ * @brief 16λλչΪ816λ֣ÿΪӦֽڵ2λֵ(λǰ)
+ */
+STEGO_TARGET("sse2")
+inline __m128i expandPairs16(uint32_t d)
+{
+	__m128i e = expand16(d);
+	__m128i hi = _mm_slli_epi16(_mm_and_si128(e, _mm_set1_epi16(0x00FF)), 1);
+	return _mm_add_epi16(hi, _mm_srli_epi16(e, 8));
+}
+
+template <int C, int MASK, int BITS>
+STEGO_TARGET("sse2")
+size_t extractSse2(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+{
+	// ǰر߽
+	size_t head = (C - pos % C) % C;
+	size_t done = extractScalar(carrier, min(carrierSize, pos + head), pos, dst, dstBit, numBits, p);
+	if (done == numBits) return done;
+
+	const VectorPattern vp = cachedPattern<C, MASK, BITS, 16>();
+	const bool dense = (MASK == (1 << C) - 1);
+	const SoftBitTables& tables = softBitTables();
+	BitSink sink(dst, dstBit + done);
+	size_t remaining = numBits - done;
+
+	int k = 0;
+	while (pos + 16 <= carrierSize && remaining > vp.total[k]) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(carrier + pos));
+		uint32_t planes[2];
+		if (BITS == 1) {
+			planes[0] = static_cast<uint32_t>(_mm_movemask_epi8(_mm_slli_epi64(v, 7)));
+		}
+		else {
+			// ֽڵĵ1λ0λõ˳еλ
+			__m128i hi = _mm_slli_epi64(v, 6);
+			__m128i lo = _mm_slli_epi64(v, 7);
+			planes[0] = static_cast<uint32_t>(_mm_movemask_epi8(_mm_unpacklo_epi8(hi, lo)));
+			planes[1] = static_cast<uint32_t>(_mm_movemask_epi8(_mm_unpackhi_epi8(hi, lo)));
+		}
+		for (int s = 0; s < BITS; ++s) {
+			uint32_t bits = dense ? planes[s] : softCompact(tables, planes[s], vp.mask[k][s], 2);
+			sink.put(bits, vp.count[k][s]);
+		}
+		remaining -= vp.total[k];
+		pos += 16;
+		if (++k == vp.vectors) k = 0;
+	}
+	sink.finish();
+
+	// βʣλ
+	done = numBits - remaining;
+	done += extractScalar(carrier, carrierSize, pos, dst, dstBit + done, numBits - done, p);
+	return done;
+}
+
+template <int C, int MASK, int BITS>
+STEGO_TARGET("sse2")
+size_t embedSse2(unsigned char* carrier, size_t carrierSize, size_t& pos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+{
+	size_t head = (C - pos % C) % C;
+	size_t done = embedScalar(carrier, min(carrierSize, pos + head), pos, src, srcBit, numBits, p);
+	if (done == numBits) return done;
+
+	const VectorPattern vp = cachedPattern<C, MASK, BITS, 16>();
+	const bool dense = (MASK == (1 << C) - 1);
+	const SoftBitTables& tables = softBitTables();
+	BitSource source(src, srcBit + done);
+	size_t remaining = numBits - done;
+
+	int k = 0;
+	while (pos + 16 <= carrierSize && remaining > vp.total[k]) {
+		__m128i vals;
+		if (BITS == 1) {
+			uint32_t bits = source.take(vp.count[k][0]);
+			if (!dense) bits = softDeposit(tables, bits, vp.mask[k][0], 2);
+			vals = expand16(bits);
+		}
+		else {
+			__m128i words[2];
+			for (int s = 0; s < 2; ++s) {
+				uint32_t bits = source.take(vp.count[k][s]);
+				if (!dense) bits = softDeposit(tables, bits, vp.mask[k][s], 2);
+				words[s] = expandPairs16(bits);
+			}
+			vals = _mm_packus_epi16(words[0], words[1]);
+		}
+		remaining -= vp.total[k];
+
+		__m128i clear = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vp.clear[k]));
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(carrier + pos));
+		v = _mm_or_si128(_mm_and_si128(v, clear), vals);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(carrier + pos), v);
+		pos += 16;
+		if (++k == vp.vectors) k = 0;
+	}
+
+	done = numBits - remaining;
+	done += embedScalar(carrier, carrierSize, pos, src, srcBit + done, numBits - done, p);
+	return done;
+}
+
+/* ---------------------------------------------------------------------------
+ * AVX2ں(ʹBMI2 pext/pdep)
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief 32λչΪ320x00/0x01ֽ
+ */
+STEGO_TARGET("avx2")
+inline __m256i expand32(uint32_t d)
+{
+	const __m256i shuf = _mm256_setr_epi8(
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+		2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+	const __m256i sel = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+	__m256i b = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(d)), shuf);
+	b = _mm256_cmpeq_epi8(_mm256_and_si256(b, sel), sel);
+	return _mm256_and_si256(b, _mm256_set1_epi8(1));
+}
+
+template <int C, int MASK, int BITS>
+STEGO_TARGET("avx2,bmi2")
+size_t extractAvx2(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+{
+	size_t head = (C - pos % C) % C;
+	size_t done = extractScalar(carrier, min(carrierSize, pos + head), pos, dst, dstBit, numBits, p);
+	if (done == numBits) return done;
+
+	const VectorPattern vp = cachedPattern<C, MASK, BITS, 32>();
+	const bool dense = (MASK == (1 << C) - 1);
+	BitSink sink(dst, dstBit + done);
+	size_t remaining = numBits - done;
+
+	int k = 0;
+	while (pos + 32 <= carrierSize && remaining > vp.total[k]) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(carrier + pos));
+		uint32_t planes[2];
+		if (BITS == 1) {
+			planes[0] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi64(v, 7)));
+		}
+		else {
+			// unpack128λͨУ64λʹ/ֱ߰Ӧǰ/16ֽ
+			v = _mm256_permute4x64_epi64(v, 0xD8);
+			__m256i hi = _mm256_slli_epi64(v, 6);
+			__m256i lo = _mm256_slli_epi64(v, 7);
+			planes[0] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_unpacklo_epi8(hi, lo)));
+			planes[1] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_unpackhi_epi8(hi, lo)));
+		}
+		for (int s = 0; s < BITS; ++s) {
+			uint32_t bits = dense ? planes[s] : _pext_u32(planes[s], vp.mask[k][s]);
+			sink.put(bits, vp.count[k][s]);
+		}
+		remaining -= vp.total[k];
+		pos += 32;
+		if (++k == vp.vectors) k = 0;
+	}
+	sink.finish();
+
+	done = numBits - remaining;
+	done += extractScalar(carrier, carrierSize, pos, dst, dstBit + done, numBits - done, p);
+	return done;
+}
+
+template <int C, int MASK, int BITS>
+STEGO_TARGET("avx2,bmi2")
+size_t embedAvx2(unsigned char* carrier, size_t carrierSize, size_t& pos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+{
+	size_t head = (C - pos % C) % C;
+	size_t done = embedScalar(carrier, min(carrierSize, pos + head), pos, src, srcBit, numBits, p);
+	if (done == numBits) return done;
+
+	const VectorPattern vp = cachedPattern<C, MASK, BITS, 32>();
+	const bool dense = (MASK == (1 << C) - 1);
+	BitSource source(src, srcBit + done);
+	size_t remaining = numBits - done;
+
+	int k = 0;
+	while (pos + 32 <= carrierSize && remaining > vp.total[k]) {
+		__m256i vals;
+		if (BITS == 1) {
+			uint32_t bits = source.take(vp.count[k][0]);
+			if (!dense) bits = _pdep_u32(bits, vp.mask[k][0]);
+			vals = expand32(bits);
+		}
+		else {
+			// λչΪֽںϲΪ2λֵpackusͨ64λָ˳
+			__m256i words[2];
+			for (int s = 0; s < 2; ++s) {
+				uint32_t bits = source.take(vp.count[k][s]);
+				if (!dense) bits = _pdep_u32(bits, vp.mask[k][s]);
+				words[s] = _mm256_maddubs_epi16(expand32(bits), _mm256_set1_epi16(0x0102));
+			}
+			vals = _mm256_permute4x64_epi64(_mm256_packus_epi16(words[0], words[1]), 0xD8);
+		}
+		remaining -= vp.total[k];
+
+		__m256i clear = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vp.clear[k]));
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(carrier + pos));
+		v = _mm256_or_si256(_mm256_and_si256(v, clear), vals);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(carrier + pos), v);
+		pos += 32;
+		if (++k == vp.vectors) k = 0;
+	}
+
+	done = numBits - remaining;
+	done += embedScalar(carrier, carrierSize, pos, src, srcBit + done, numBits - done, p);
+	return done;
+}
+
+/**
+ * @struct Sse2Kernel
+ * @brief SSE2ػںˣʱתػں
+ */
+template <int C, int MASK, int BITS>
+struct Sse2Kernel {
+	static size_t embed(unsigned char* carrier, size_t carrierSize, size_t& pos,
+		const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+	{
+		if (numBits < kSimdMinBits) return ScalarKernel<C, MASK, BITS>::embed(carrier, carrierSize, pos, src, srcBit, numBits, p);
+		return embedSse2<C, MASK, BITS>(carrier, carrierSize, pos, src, srcBit, numBits, p);
+	}
+
+	static size_t extract(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+		unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+	{
+		if (numBits < kSimdMinBits) return ScalarKernel<C, MASK, BITS>::extract(carrier, carrierSize, pos, dst, dstBit, numBits, p);
+		return extractSse2<C, MASK, BITS>(carrier, carrierSize, pos, dst, dstBit, numBits, p);
+	}
+};
+
+/**
+ * @struct Avx2Kernel
+ * @brief AVX2ػںˣʱתػں
+ */
+template <int C, int MASK, int BITS>
+struct Avx2Kernel {
+	static size_t embed(unsigned char* carrier, size_t carrierSize, size_t& pos,
+		const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& p)
+	{
+		if (numBits < kSimdMinBits) return ScalarKernel<C, MASK, BITS>::embed(carrier, carrierSize, pos, src, srcBit, numBits, p);
+		return embedAvx2<C, MASK, BITS>(carrier, carrierSize, pos, src, srcBit, numBits, p);
+	}
+
+	static size_t extract(const unsigned char* carrier, size_t carrierSize, size_t& pos,
+		unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& p)
+	{
+		if (numBits < kSimdMinBits) return ScalarKernel<C, MASK, BITS>::extract(carrier, carrierSize, pos, dst, dstBit, numBits, p);
+		return extractAvx2<C, MASK, BITS>(carrier, carrierSize, pos, dst, dstBit, numBits, p);
+	}
+};
+
+/**
+ * @brief ⵱ǰCPUֵ֧ں
+ * @return õں
+ */
+LsbKernel detectBestKernel()
+{
+	const CpuFeatures& cpu = cpuFeatures();
+	if (cpu.avx2 && cpu.bmi2) return LSB_KERNEL_AVX2;
+	if (cpu.sse2) return LSB_KERNEL_SSE2;
+	return LSB_KERNEL_SCALAR;
+}
+
+#else
+
+LsbKernel detectBestKernel()
+{
+	return LSB_KERNEL_SCALAR;
+}
+
+#endif // STEGO_X86
+
+/**
+ * @brief ʹģʽǷϷ
+ */
+bool validPattern(const LsbPattern& p)
+{
+	return (p.channels == 3 || p.channels == 4) &&
+		(p.bitsPerChannel == 1 || p.bitsPerChannel == 2);
+}
+
+/**
+ * @brief ޿ͨʱĿں
+ *
+ * λʵһ£ɨʣдκλ
+ */
+size_t embedNone(unsigned char*, size_t carrierSize, size_t& pos,
+	const unsigned char*, size_t, size_t numBits, const LsbPattern&)
+{
+	if (numBits > 0 && pos < carrierSize) pos = carrierSize;
+	return 0;
+}
+
+size_t extractNone(const unsigned char*, size_t carrierSize, size_t& pos,
+	unsigned char*, size_t, size_t numBits, const LsbPattern&)
+{
+	if (numBits > 0 && pos < carrierSize) pos = carrierSize;
+	return 0;
+}
+
+/**
+ * @struct KernelFns
+ * @brief ػں˱
+ */
+struct KernelFns {
+	LsbEmbedFn   embed;
+	LsbExtractFn extract;
+};
+
+#define LSB_KERNEL_ENTRY(Impl, C, M, B) { &Impl<C, M, B>::embed, &Impl<C, M, B>::extract }
+#define LSB_KERNEL_MASKS(Impl, C, B) { { embedNone, extractNone }, \
+	LSB_KERNEL_ENTRY(Impl, C, 1, B), LSB_KERNEL_ENTRY(Impl, C, 2, B), LSB_KERNEL_ENTRY(Impl, C, 3, B), \
+	LSB_KERNEL_ENTRY(Impl, C, 4, B), LSB_KERNEL_ENTRY(Impl, C, 5, B), LSB_KERNEL_ENTRY(Impl, C, 6, B), \
+	LSB_KERNEL_ENTRY(Impl, C, 7, B) }
+#define LSB_KERNEL_TABLE(Impl) { \
+	{ LSB_KERNEL_MASKS(Impl, 3, 1), LSB_KERNEL_MASKS(Impl, 3, 2) }, \
+	{ LSB_KERNEL_MASKS(Impl, 4, 1), LSB_KERNEL_MASKS(Impl, 4, 2) } }
+
+/// ػں˱±Ϊ[ͨ-3][ÿͨλ-1][ͨ]
+const KernelFns kScalarKernels[2][2][8] = LSB_KERNEL_TABLE(ScalarKernel);
+#ifdef STEGO_X86
+const KernelFns kSse2Kernels[2][2][8] = LSB_KERNEL_TABLE(Sse2Kernel);
+const KernelFns kAvx2Kernels[2][2][8] = LSB_KERNEL_TABLE(Avx2Kernel);
+#endif
+
+#undef LSB_KERNEL_TABLE
+#undef LSB_KERNEL_MASKS
+#undef LSB_KERNEL_ENTRY
+
+} // namespace
+
+/**
+ * @brief ںͽΪǰCPUʵʿõʵ
+ *
+ * ںͰУʵֲʱ˵õʵ֡
+ *
+ * @param[in] requested ں
+ * @return õں
+ */
+LsbKernel lsbResolveKernel(LsbKernel requested)
+{
+	static const LsbKernel best = detectBestKernel();
+	if (requested == LSB_KERNEL_AUTO || requested > best) return best;
+	return requested;
+}
+
+/**
+ * @brief ȡں
+ * @param[in] kernel ں
+ * @return ַ
+ */
+const char* lsbKernelName(LsbKernel kernel)
+{
+	switch (kernel) {
+	case LSB_KERNEL_AUTO:   return "auto";
+	case LSB_KERNEL_SCALAR: return "scalar";
+	case LSB_KERNEL_SSE2:   return "sse2";
+	case LSB_KERNEL_AVX2:   return "avx2";
+	default:                return "unknown";
+	}
+}
+
+/**
+ * @brief ʹģʽѡں
+ *
+ * ͨȽȥͨλ(ЩλӦκֽ)
+ * B/G/Rͨ7ϲõػʵ֣
+ * 4ͨ(alpha)ϲãʹͨñʵ֡
+ *
+ * @param[in] kernel ں
+ * @param[in] pattern ʹģʽ
+ * @return ѡں
+ */
+LsbKernelOps lsbSelectKernel(LsbKernel kernel, const LsbPattern& pattern)
+{
+	LsbKernelOps ops;
+	ops.pattern = pattern;
+	ops.embedFn = embedNone;
+	ops.extractFn = extractNone;
+	if (!validPattern(pattern)) return ops;
+
+	ops.pattern.channelMask = static_cast<uint16_t>(pattern.channelMask & ((1 << pattern.channels) - 1));
+	if (ops.pattern.channelMask > 0x07) {
+		ops.embedFn = embedScalar;
+		ops.extractFn = extractScalar;
+		return ops;
+	}
+
+	const KernelFns (*table)[2][8] = kScalarKernels;
+	ops.kernel = lsbResolveKernel(kernel);
+#ifdef STEGO_X86
+	if (ops.kernel == LSB_KERNEL_AVX2) table = kAvx2Kernels;
+	else if (ops.kernel == LSB_KERNEL_SSE2) table = kSse2Kernels;
+#endif
+	const KernelFns& fns = table[pattern.channels - 3][pattern.bitsPerChannel - 1][ops.pattern.channelMask];
+	ops.embedFn = fns.embed;
+	ops.extractFn = fns.extract;
+	return ops;
+}
+
+/**
+ * @brief λǶ
+ */
+size_t lsbEmbed(LsbKernel kernel, unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& pattern)
+{
+	return lsbSelectKernel(kernel, pattern).embed(carrier, carrierSize, carrierPos, src, srcBit, numBits);
+}
+
+/**
+ * @brief ȡλ
+ */
+size_t lsbExtract(LsbKernel kernel, const unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& pattern)
+{
+	return lsbSelectKernel(kernel, pattern).extract(carrier, carrierSize, carrierPos, dst, dstBit, numBits);
+}
+
+/**
+ * @brief ׷صĵλλƽ
+ */
+size_t lsbAppendPlanes(LsbPlanes& planes, const unsigned char* carrier, size_t carrierSize, size_t maxPixels)
+{
+	int C = planes.channels;
+	if (C < 1 || C > 4 || planes.pixels >= maxPixels) return 0;
+
+	size_t count = min(carrierSize / C, maxPixels - planes.pixels);
+	size_t words = (planes.pixels + count + 63) / 64;
+	for (int ch = 0; ch < C; ++ch) {
+		planes.bit0[ch].resize(words, 0);
+		planes.bit1[ch].resize(words, 0);
+	}
+
+	const unsigned char* px = carrier;
+	for (size_t i = planes.pixels; i < planes.pixels + count; ++i, px += C) {
+		size_t w = i >> 6;
+		uint64_t bit = 1ull << (i & 63);
+		for (int ch = 0; ch < C; ++ch) {
+			if (px[ch] & 0x01) planes.bit0[ch][w] |= bit;
+			if (px[ch] & 0x02) planes.bit1[ch][w] |= bit;
+		}
+	}
+	planes.pixels += count;
+	return count;
+}
+
+/**
+ * @brief λƽƵλ
+ */
+size_t lsbDecodePlanes(const LsbPlanes& planes, uint16_t channelMask, int bitsPerChannel,
+	unsigned char* dst, size_t numBits)
+{
+	// ͨƫУ2λģʽελ
+	int chans[4];
+	int used = 0;
+	for (int ch = 0; ch < planes.channels && ch < 4; ++ch) {
+		if ((channelMask >> ch) & 0x01) chans[used++] = ch;
+	}
+	if (used == 0 || (bitsPerChannel != 1 && bitsPerChannel != 2)) return 0;
+
+	size_t done = 0;
+	unsigned acc = 0;
+	for (size_t i = 0; i < planes.pixels && done < numBits; ++i) {
+		size_t w = i >> 6;
+		int shift = static_cast<int>(i & 63);
+		for (int k = 0; k < used && done < numBits; ++k) {
+			int ch = chans[k];
+			if (bitsPerChannel == 2) {
+				acc = (acc << 1) | static_cast<unsigned>((planes.bit1[ch][w] >> shift) & 0x01);
+				if ((++done & 7) == 0) dst[(done >> 3) - 1] = static_cast<unsigned char>(acc);
+				if (done == numBits) break;
+			}
+			acc = (acc << 1) | static_cast<unsigned>((planes.bit0[ch][w] >> shift) & 0x01);
+			if ((++done & 7) == 0) dst[(done >> 3) - 1] = static_cast<unsigned char>(acc);
+		}
+	}
+	return done & ~static_cast<size_t>(7);
+}
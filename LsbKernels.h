@@ -0,0 +1,173 @@
+#ifndef LSB_KERNELS_H
+#define LSB_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file LsbKernels.h
+ * @brief ˳LSBǶ/ȡں
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ļ˳/ǿLSBģʽĵײλںˣλʵ
+ * SSE2/AVX2ʵ֣ʱCPUѡں˵ʵλһ¡
+ */
+
+ /**
+  * @enum LsbKernel
+  * @brief LSBںʵ
+  *
+  * StegoContextָԱA/BԱȣָʵڵǰCPUϲʱԶˡ
+  */
+enum LsbKernel : uint16_t {
+	LSB_KERNEL_AUTO = 0,   ///< ʱԶѡǰCPUֵ֧ʵ
+	LSB_KERNEL_SCALAR = 1, ///< λʵ(οʵ)
+	LSB_KERNEL_SSE2 = 2,   ///< SSE2ʵ(16ֽ)
+	LSB_KERNEL_AVX2 = 3    ///< AVX2+BMI2ʵ(32ֽ)
+};
+
+/**
+ * @struct LsbPattern
+ * @brief ֽڵʹģʽ
+ *
+ * ֽڵͨΪƫƶchannelsȡģ
+ * ͨchannelMaskλֽÿbitsPerChannelλ(λǰ)
+ */
+struct LsbPattern {
+	int      channels = 4;       ///< ÿֽ(34)
+	uint16_t channelMask = 0x01; ///< õͨ
+	int      bitsPerChannel = 1; ///< ÿֽڳصλ(12)
+};
+
+/// Ƕ뺯ʵǶλ
+typedef size_t (*LsbEmbedFn)(unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& pattern);
+
+/// ȡʵȡλ
+typedef size_t (*LsbExtractFn)(const unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& pattern);
+
+/**
+ * @struct LsbKernelOps
+ * @brief ĳһʹģʽѡں
+ *
+ * lsbSelectKernel(ں, ͨ, ÿͨλ, ͨ)õ
+ * ϶Ӧػʵ֣ڲѭвȡģͨжϡ
+ * ͬһģʽĶζдֻѡһΡ
+ */
+struct LsbKernelOps {
+	LsbKernel    kernel = LSB_KERNEL_SCALAR; ///< ʵʹõں
+	LsbPattern   pattern;                    ///< 淶ʹģʽ
+	LsbEmbedFn   embedFn = nullptr;          ///< Ƕʵ
+	LsbExtractFn extractFn = nullptr;        ///< ȡʵ
+
+	/// ǶλͬlsbEmbed
+	size_t embed(unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+		const unsigned char* src, size_t srcBit, size_t numBits) const
+	{
+		return embedFn(carrier, carrierSize, carrierPos, src, srcBit, numBits, pattern);
+	}
+
+	/// ȡλͬlsbExtract
+	size_t extract(const unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+		unsigned char* dst, size_t dstBit, size_t numBits) const
+	{
+		return extractFn(carrier, carrierSize, carrierPos, dst, dstBit, numBits, pattern);
+	}
+};
+
+/**
+ * @brief ںͽΪǰCPUʵʿõʵ
+ * @param[in] requested ں
+ * @return õں(᷵LSB_KERNEL_AUTO)
+ */
+LsbKernel lsbResolveKernel(LsbKernel requested);
+
+/**
+ * @brief ȡں
+ * @param[in] kernel ں
+ * @return ַ"scalar""sse2""avx2"
+ */
+const char* lsbKernelName(LsbKernel kernel);
+
+/**
+ * @brief ʹģʽѡں
+ * @param[in] kernel ں
+ * @param[in] pattern ʹģʽ
+ * @return ѡںˣģʽϷ޿ͨʱд0
+ */
+LsbKernelOps lsbSelectKernel(LsbKernel kernel, const LsbPattern& pattern);
+
+/**
+ * @brief λǶ
+ * @note ÿεöѡںˣζдͬһģʽʱӦʹlsbSelectKernel
+ * @param[in] kernel ں
+ * @param[in,out] carrier ʼַ
+ * @param[in] carrierSize С(ֽ)
+ * @param[in,out] carrierPos ʼƫƣʱΪʹõֽ֮ƫ
+ * @param[in] src Դ
+ * @param[in] srcBit Դʼλ(src[0]λΪ0)
+ * @param[in] numBits ҪǶλ
+ * @param[in] pattern ʹģʽ
+ * @return ʵǶλСnumBitsʾ岻
+ */
+size_t lsbEmbed(LsbKernel kernel, unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	const unsigned char* src, size_t srcBit, size_t numBits, const LsbPattern& pattern);
+
+/**
+ * @brief ȡλ
+ * @note ÿεöѡںˣζдͬһģʽʱӦʹlsbSelectKernel
+ * @param[in] kernel ں
+ * @param[in] carrier ʼַ
+ * @param[in] carrierSize С(ֽ)
+ * @param[in,out] carrierPos ʼƫƣʱΪʹõֽ֮ƫ
+ * @param[out] dst Ŀ껺д[dstBit, dstBit+numBits)Χڵλ
+ * @param[in] dstBit Ŀʼλ(dst[0]λΪ0)
+ * @param[in] numBits Ҫȡλ
+ * @param[in] pattern ʹģʽ
+ * @return ʵȡλСnumBitsʾ岻
+ */
+size_t lsbExtract(LsbKernel kernel, const unsigned char* carrier, size_t carrierSize, size_t& carrierPos,
+	unsigned char* dst, size_t dstBit, size_t numBits, const LsbPattern& pattern);
+
+/**
+ * @struct LsbPlanes
+ * @brief ͨĵλλƽ(ṹ)
+ *
+ * iصchֽͨڵλbit0[ch]ĵiλελbit1[ch]ĵiλ
+ * (iλλڵi/64֣ɵ͵)
+ * ͬһλƽƵͨÿͨλµλ
+ * Զʱֻɨһ忪ͷɵõ˳/ǿģʽѡͷ
+ */
+struct LsbPlanes {
+	int    channels = 0;           ///< ÿֽ(34)
+	size_t pixels = 0;             ///< ռ
+	std::vector<uint64_t> bit0[4]; ///< ͨλ
+	std::vector<uint64_t> bit1[4]; ///< ͨĴελ
+};
+
+/**
+ * @brief ׷صĵλλƽ
+ * @param[in,out] planes λƽ棬channels
+ * @param[in] carrier ʼַλر߽
+ * @param[in] carrierSize С(ֽ)ĩβһصֽں
+ * @param[in] maxPixels λƽռ
+ * @return ׷ӵ
+ */
+size_t lsbAppendPlanes(LsbPlanes& planes, const unsigned char* carrier, size_t carrierSize, size_t maxPixels);
+
+/**
+ * @brief λƽƵĳһʹģʽµλ
+ * @note ͬһlsbExtractȡͬ
+ * @param[in] planes λƽ
+ * @param[in] channelMask ͨ
+ * @param[in] bitsPerChannel ÿͨλ(12)
+ * @param[out] dst Ŀ껺λǰд
+ * @param[in] numBits ҪƵλΪ8ı
+ * @return ʵƵλλƽеزʱСnumBits
+ */
+size_t lsbDecodePlanes(const LsbPlanes& planes, uint16_t channelMask, int bitsPerChannel,
+	unsigned char* dst, size_t numBits);
+
+#endif // LSB_KERNELS_H
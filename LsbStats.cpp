@@ -0,0 +1,115 @@
+#include "LsbStats.h"
+#include <cmath>
+
+/**
+ * @file LsbStats.cpp
+ * @brief λͳƼʵ
+ * @copyright Copyright 2025, Ϣص6
+ */
+
+using namespace std;
+
+namespace {
+
+/// ֵԵڸֵʱ飬ϡȡֵʹʧЧ
+const double kMinExpected = 5.0;
+
+/**
+ * @brief ϲ಻ȫ٤Q(a, x)
+ *
+ * x < a + 1ʱüP(a, x)ȡʽ(Lentz㷨)ֱQ(a, x)
+ *
+ * @param[in] a ״0
+ * @param[in] x Ա벻С0
+ * @return Q(a, x)
+ */
+double gammaQ(double a, double x)
+{
+	const int kMaxIter = 500;
+	const double kEps = 1e-12;
+	const double kTiny = 1e-300;
+	if (x <= 0.0) return 1.0;
+	double lead = a * log(x) - x - lgamma(a);
+
+	if (x < a + 1.0) {
+		double term = 1.0 / a;
+		double sum = term;
+		for (int n = 1; n < kMaxIter; ++n) {
+			term *= x / (a + n);
+			sum += term;
+			if (fabs(term) < fabs(sum) * kEps) break;
+		}
+		return 1.0 - sum * exp(lead);
+	}
+
+	double b = x + 1.0 - a;
+	double c = 1.0 / kTiny;
+	double d = 1.0 / b;
+	double h = d;
+	for (int n = 1; n < kMaxIter; ++n) {
+		double an = -n * (n - a);
+		b += 2.0;
+		d = an * d + b;
+		if (fabs(d) < kTiny) d = kTiny;
+		c = b + an / c;
+		if (fabs(c) < kTiny) c = kTiny;
+		d = 1.0 / d;
+		double delta = d * c;
+		h *= delta;
+		if (fabs(delta - 1.0) < kEps) break;
+	}
+	return exp(lead) * h;
+}
+
+} // namespace
+
+/**
+ * @brief ͨۼֱֵֽͼ
+ *
+ * ͨʹöļֽڵڲͬϣ
+ * дͬһʱĴ洢תȴ
+ */
+void lsbAccumulateHistograms(const unsigned char* data, size_t size, int channels, LsbHistogram* hist)
+{
+	if (channels < 1 || channels > 4) return;
+	size_t pixels = size / channels;
+	const unsigned char* px = data;
+	switch (channels) {
+	case 4:
+		for (size_t i = 0; i < pixels; ++i, px += 4) {
+			++hist[0][px[0]]; ++hist[1][px[1]]; ++hist[2][px[2]]; ++hist[3][px[3]];
+		}
+		break;
+	case 3:
+		for (size_t i = 0; i < pixels; ++i, px += 3) {
+			++hist[0][px[0]]; ++hist[1][px[1]]; ++hist[2][px[2]];
+		}
+		break;
+	default:
+		for (size_t i = 0; i < pixels; ++i, px += channels) {
+			for (int ch = 0; ch < channels; ++ch) ++hist[ch][px[ch]];
+		}
+		break;
+	}
+}
+
+/**
+ * @brief ֱͼֵԿ
+ *
+ * ͳΪ  (h[2k] - e)^2 / ee = (h[2k] + h[2k+1]) / 2
+ * ɶΪֵ1俨ֲϲʡ
+ */
+double lsbPairsOfValues(const LsbHistogram& hist)
+{
+	double chi2 = 0.0;
+	int pairs = 0;
+	for (int k = 0; k < 128; ++k) {
+		double expected = (static_cast<double>(hist[2 * k]) + hist[2 * k + 1]) / 2.0;
+		if (expected < kMinExpected) continue;
+		double diff = hist[2 * k] - expected;
+		chi2 += diff * diff / expected;
+		++pairs;
+	}
+	if (pairs < 2) return 1.0;
+	return gammaQ((pairs - 1) / 2.0, chi2 / 2.0);
+}
@@ -0,0 +1,35 @@
+#ifndef LSB_STATS_H
+#define LSB_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file LsbStats.h
+ * @brief λͳƼ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ṩֵԿ(pairs of values)Ծλ滻λȡֵ2k2k+1ĳִȣ
+ * ͳƫСԶƸͨͷ˳Ƕĸʣݴѡ
+ */
+
+/// ÿֱֵֽͨͼ
+typedef uint32_t LsbHistogram[256];
+
+/**
+ * @brief ͨۼֱֵֽͼ
+ * @param[in] data ݣλر߽
+ * @param[in] size ݴС(ֽ)ĩβһصֽں
+ * @param[in] channels ÿֽ(1~4)
+ * @param[in,out] hist ֱͨͼchannelsۼӵԭм
+ */
+void lsbAccumulateHistograms(const unsigned char* data, size_t size, int channels, LsbHistogram* hist);
+
+/**
+ * @brief ֱͼֵԿ
+ * @param[in] hist ֱͨͼ
+ * @return λλ滻ĸ(0~1)ֲϲʣԼʱ1
+ */
+double lsbPairsOfValues(const LsbHistogram& hist);
+
+#endif // LSB_STATS_H
@@ -0,0 +1,420 @@
+#include "MappedFile.h"
+#include <iostream>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+/**
+ * @file MappedFile.cpp
+ * @brief ļڴӳװʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * WindowsʹCreateFileMapping/MapViewOfFileƽ̨ʹmmap
+ * ƫƶдWindowsʹôOVERLAPPEDƫƵReadFile/WriteFileƽ̨ʹpread/pwrite
+ */
+
+using namespace std;
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+/**
+ * @brief 򿪲ӳļ
+ *
+ * ʷʽѡ򿪱־ҳ汣ԣ
+ * - ֻֻ򿪣ֻӳ
+ * - ˽Уֻ򿪣дʱӳ(޸Ĳдļ)
+ * - д򿪣дӳ
+ *
+ * @param[in] filename ļ·
+ * @param[in] access ӳʷʽ
+ * @return ɹtrueʧܷfalse
+ */
+bool MappedFile::open(const std::string& filename, MapAccess access)
+{
+	close();
+	m_access = access;
+
+#ifdef _WIN32
+	DWORD desired = (access == MAP_ACCESS_SHARED) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+	HANDLE file = CreateFileA(filename.c_str(), desired, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		cerr << "[] ޷ļ: " << filename << endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+		static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<size_t>(-1)) {
+		cerr << "[] ļС޷ӳ: " << filename << endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	DWORD protect = PAGE_READONLY;
+	DWORD viewAccess = FILE_MAP_READ;
+	if (access == MAP_ACCESS_PRIVATE) { protect = PAGE_WRITECOPY; viewAccess = FILE_MAP_COPY; }
+	if (access == MAP_ACCESS_SHARED) { protect = PAGE_READWRITE; viewAccess = FILE_MAP_WRITE; }
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, protect, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		cerr << "[] ļӳʧ: " << filename << endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, viewAccess, 0, 0, 0);
+	if (view == nullptr) {
+		cerr << "[] ӳļͼʧ: " << filename << endl;
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_data = static_cast<unsigned char*>(view);
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = ::open(filename.c_str(), (access == MAP_ACCESS_SHARED) ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		cerr << "[] ޷ļ: " << filename << endl;
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		cerr << "[] ļС޷ӳ: " << filename << endl;
+		::close(fd);
+		return false;
+	}
+
+	int prot = (access == MAP_ACCESS_READONLY) ? PROT_READ : (PROT_READ | PROT_WRITE);
+	int flags = (access == MAP_ACCESS_SHARED) ? MAP_SHARED : MAP_PRIVATE;
+	void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), prot, flags, fd, 0);
+	if (addr == MAP_FAILED) {
+		cerr << "[] ӳļʧ: " << filename << endl;
+		::close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	m_data = static_cast<unsigned char*>(addr);
+	m_size = static_cast<size_t>(st.st_size);
+#endif
+	return true;
+}
+
+/**
+ * @brief ˽дʱƷʽٴӳһӳļ
+ *
+ * sourceļ(WindowsDuplicateHandleƽ̨dup)˽зʽӳ䣬
+ * ӳСȡsourceӳС
+ *
+ * @param[in] source ӳĶ
+ * @return ɹtrueʧܷfalse
+ */
+bool MappedFile::openCopy(const MappedFile& source)
+{
+	close();
+	if (!source.m_data) return false;
+	m_access = MAP_ACCESS_PRIVATE;
+
+#ifdef _WIN32
+	HANDLE file = nullptr;
+	HANDLE process = GetCurrentProcess();
+	if (!DuplicateHandle(process, static_cast<HANDLE>(source.m_file), process, &file,
+		0, FALSE, DUPLICATE_SAME_ACCESS)) {
+		cerr << "[] ļʧ" << endl;
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		cerr << "[] ļӳʧ" << endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, source.m_size);
+	if (view == nullptr) {
+		cerr << "[] ӳļͼʧ" << endl;
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_data = static_cast<unsigned char*>(view);
+#else
+	int fd = ::dup(source.m_fd);
+	if (fd < 0) {
+		cerr << "[] ļʧ" << endl;
+		return false;
+	}
+
+	void* addr = mmap(nullptr, source.m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		cerr << "[] ӳļʧ" << endl;
+		::close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	m_data = static_cast<unsigned char*>(addr);
+#endif
+	m_size = source.m_size;
+	return true;
+}
+
+/**
+ * @brief ӳ䲢رļ
+ *
+ * ӳδͬ޸ɲϵͳڽӳ첽дء
+ */
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+	if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	if (m_data) munmap(m_data, m_size);
+	if (m_fd >= 0) ::close(m_fd);
+	m_fd = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+/**
+ * @brief ӳָΧ޸ͬ
+ *
+ * @param[in] offset ʼƫ(ֽ)
+ * @param[in] length ͬ(ֽ)0ʾļĩβ
+ * @return ɹtrueǹӳֱӷtrue
+ */
+bool MappedFile::flush(size_t offset, size_t length)
+{
+	if (!m_data || m_access != MAP_ACCESS_SHARED) return true;
+	if (offset >= m_size) return true;
+	if (length == 0 || length > m_size - offset) length = m_size - offset;
+
+#ifdef _WIN32
+	if (!FlushViewOfFile(m_data + offset, length)) return false;
+	return FlushFileBuffers(static_cast<HANDLE>(m_file)) != 0;
+#else
+	// msyncҪʼַҳ
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t aligned = offset - offset % page;
+	return msync(m_data + aligned, length + (offset - aligned), MS_SYNC) == 0;
+#endif
+}
+
+/**
+ * @brief жϸ·Ƿ뵱ǰӳļΪͬһļ
+ *
+ * @param[in] filename Ƚϵļ·
+ * @return ͬһļtrueļڻδӳ䷵false
+ */
+bool MappedFile::refersTo(const std::string& filename) const
+{
+	if (!m_data) return false;
+
+#ifdef _WIN32
+	HANDLE other = CreateFileA(filename.c_str(), 0,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (other == INVALID_HANDLE_VALUE) return false;
+
+	BY_HANDLE_FILE_INFORMATION a, b;
+	bool same = GetFileInformationByHandle(static_cast<HANDLE>(m_file), &a) &&
+		GetFileInformationByHandle(other, &b) &&
+		a.dwVolumeSerialNumber == b.dwVolumeSerialNumber &&
+		a.nFileIndexHigh == b.nFileIndexHigh &&
+		a.nFileIndexLow == b.nFileIndexLow;
+	CloseHandle(other);
+	return same;
+#else
+	struct stat a, b;
+	if (fstat(m_fd, &a) != 0 || stat(filename.c_str(), &b) != 0) return false;
+	return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+#endif
+}
+
+PositionalFile::~PositionalFile()
+{
+	close();
+}
+
+/**
+ * @brief Ѵڵļ¼ļС
+ * @param[in] filename ļ·
+ * @param[in] writable ǷԶдʽ
+ * @return ɹtrueʧܷfalse
+ */
+bool PositionalFile::open(const std::string& filename, bool writable)
+{
+	close();
+
+#ifdef _WIN32
+	DWORD desired = writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+	HANDLE file = CreateFileA(filename.c_str(), desired, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		cerr << "[] ޷ļ: " << filename << endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) ||
+		static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<size_t>(-1)) {
+		cerr << "[] ޷ȡļС: " << filename << endl;
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = ::open(filename.c_str(), writable ? O_RDWR : O_RDONLY);
+	if (fd < 0) {
+		cerr << "[] ޷ļ: " << filename << endl;
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < 0) {
+		cerr << "[] ޷ȡļС: " << filename << endl;
+		::close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	m_size = static_cast<size_t>(st.st_size);
+#endif
+	return true;
+}
+
+/**
+ * @brief رļ
+ */
+void PositionalFile::close()
+{
+#ifdef _WIN32
+	if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+	m_file = nullptr;
+#else
+	if (m_fd >= 0) ::close(m_fd);
+	m_fd = -1;
+#endif
+	m_size = 0;
+}
+
+/**
+ * @brief ָƫƶȡ
+ *
+ * ϵͳÿֻز(źж)ѭȡֱ򵽴ļĩβ
+ *
+ * @param[in] offset ļƫ(ֽ)
+ * @param[out] buffer Ŀ껺
+ * @param[in] length ȡ(ֽ)
+ * @return lengthֽڷtrue
+ */
+bool PositionalFile::readAt(size_t offset, void* buffer, size_t length) const
+{
+	if (!isOpen()) return false;
+	unsigned char* dst = static_cast<unsigned char*>(buffer);
+	while (length > 0) {
+#ifdef _WIN32
+		OVERLAPPED ov = {};
+		ov.Offset = static_cast<DWORD>(static_cast<unsigned long long>(offset) & 0xFFFFFFFFull);
+		ov.OffsetHigh = static_cast<DWORD>(static_cast<unsigned long long>(offset) >> 32);
+		DWORD chunk = static_cast<DWORD>(min<size_t>(length, 0x40000000));
+		DWORD got = 0;
+		if (!ReadFile(static_cast<HANDLE>(m_file), dst, chunk, &got, &ov) || got == 0) return false;
+#else
+		ssize_t got = pread(m_fd, dst, length, static_cast<off_t>(offset));
+		if (got < 0 && errno == EINTR) continue;
+		if (got <= 0) return false;
+#endif
+		dst += got;
+		offset += static_cast<size_t>(got);
+		length -= static_cast<size_t>(got);
+	}
+	return true;
+}
+
+/**
+ * @brief ָƫд
+ *
+ * readAtͬϵͳÿֻд벿ݣѭдֱȫɡ
+ *
+ * @param[in] offset ļƫ(ֽ)
+ * @param[in] buffer Դ
+ * @param[in] length д볤(ֽ)
+ * @return ȫд뷵true
+ */
+bool PositionalFile::writeAt(size_t offset, const void* buffer, size_t length)
+{
+	if (!isOpen()) return false;
+	const unsigned char* src = static_cast<const unsigned char*>(buffer);
+	while (length > 0) {
+#ifdef _WIN32
+		OVERLAPPED ov = {};
+		ov.Offset = static_cast<DWORD>(static_cast<unsigned long long>(offset) & 0xFFFFFFFFull);
+		ov.OffsetHigh = static_cast<DWORD>(static_cast<unsigned long long>(offset) >> 32);
+		DWORD chunk = static_cast<DWORD>(min<size_t>(length, 0x40000000));
+		DWORD put = 0;
+		if (!WriteFile(static_cast<HANDLE>(m_file), src, chunk, &put, &ov) || put == 0) return false;
+#else
+		ssize_t put = pwrite(m_fd, src, length, static_cast<off_t>(offset));
+		if (put < 0 && errno == EINTR) continue;
+		if (put <= 0) return false;
+#endif
+		src += put;
+		offset += static_cast<size_t>(put);
+		length -= static_cast<size_t>(put);
+	}
+	m_size = max(m_size, offset);
+	return true;
+}
+
+/**
+ * @brief ļضϻչָС
+ * @param[in] size µļС(ֽ)
+ * @return ɹtrue
+ */
+bool PositionalFile::resize(size_t size)
+{
+	if (!isOpen()) return false;
+#ifdef _WIN32
+	LARGE_INTEGER pos;
+	pos.QuadPart = static_cast<LONGLONG>(size);
+	if (!SetFilePointerEx(static_cast<HANDLE>(m_file), pos, nullptr, FILE_BEGIN) ||
+		!SetEndOfFile(static_cast<HANDLE>(m_file))) {
+		return false;
+	}
+#else
+	if (ftruncate(m_fd, static_cast<off_t>(size)) != 0) return false;
+#endif
+	m_size = size;
+	return true;
+}
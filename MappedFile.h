@@ -0,0 +1,199 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * @file MappedFile.h
+ * @brief ļڴӳװ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ļװ˿ƽ̨(Windows/POSIX)ļڴӳ䣬ΪBmpImageṩ㿽
+ * ݷʡֻ֧˽дʱƺ͹дӳ䷽ʽ
+ * ṩƫƶдPositionalFileֻȡдļֽڵĳʹá
+ */
+
+ /**
+  * @enum MapAccess
+  * @brief ļӳʷʽ
+  */
+enum MapAccess {
+	MAP_ACCESS_READONLY = 0, ///< ֻӳ䣬дӳ·Υ
+	MAP_ACCESS_PRIVATE = 1,  ///< ˽дʱӳ䣬޸ĽԱ̿ɼдļ
+	MAP_ACCESS_SHARED = 2    ///< дӳ䣬޸ֱдļ
+};
+
+/**
+ * @class MappedFile
+ * @brief ļڴӳ
+ *
+ * ļӳ䵽̵ַռ䣬ֻʵʷʵҳŻɲϵͳӴ̵롣
+ * 󲻿ɸƣʱԶӳ䲢رļ
+ */
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief 򿪲ӳļ
+	 * @param[in] filename ļ·
+	 * @param[in] access ӳʷʽ
+	 * @return ɹtrueʧܷfalse
+	 * @note ļ޷ӳ䣬false
+	 */
+	bool open(const std::string& filename, MapAccess access);
+
+	/**
+	 * @brief ˽дʱƷʽٴӳһӳļ
+	 * @param[in] source ӳĶ
+	 * @return ɹtrueʧܷfalse
+	 * @note °·ļǸsourceļsourceӳͬһļ
+	 *       δ޸ĵҳsourceҳ滺湲дʱŰҳ
+	 */
+	bool openCopy(const MappedFile& source);
+
+	/**
+	 * @brief ӳ䲢رļ
+	 */
+	void close();
+
+	/**
+	 * @brief ӳָΧ޸ͬ
+	 * @param[in] offset ʼƫ(ֽ)
+	 * @param[in] length ͬ(ֽ)0ʾļĩβ
+	 * @return ɹtrueǹӳֱӷtrue
+	 */
+	bool flush(size_t offset = 0, size_t length = 0);
+
+	/**
+	 * @brief жϸ·Ƿ뵱ǰӳļΪͬһļ
+	 * @param[in] filename Ƚϵļ·
+	 * @return ͬһļtrue
+	 * @note Ƚϵļʶ(豸/ڵк/ļ)·ַ
+	 */
+	bool refersTo(const std::string& filename) const;
+
+	/**
+	 * @brief ȡӳʼַ
+	 * @return ӳָ룬δӳʱΪnullptr
+	 */
+	unsigned char* data() const { return m_data; }
+
+	/**
+	 * @brief ȡӳС
+	 * @return ӳֽ
+	 */
+	size_t size() const { return m_size; }
+
+	/**
+	 * @brief ȡӳʷʽ
+	 * @return ʱָķʷʽ
+	 */
+	MapAccess access() const { return m_access; }
+
+	/**
+	 * @brief Ƿӳ
+	 * @return ӳ䷵true
+	 */
+	bool isOpen() const { return m_data != nullptr; }
+
+private:
+	unsigned char* m_data = nullptr;           ///< ӳʼַ
+	size_t         m_size = 0;                 ///< ӳС(ֽ)
+	MapAccess      m_access = MAP_ACCESS_READONLY; ///< ӳʷʽ
+#ifdef _WIN32
+	void*          m_file = nullptr;           ///< ļ(HANDLE)
+	void*          m_mapping = nullptr;        ///< ӳ(HANDLE)
+#else
+	int            m_fd = -1;                  ///< ļ
+#endif
+};
+
+/**
+ * @class PositionalFile
+ * @brief ƫƶдļ
+ *
+ * ÿζдʽָļƫ(POSIXΪpread/pwriteWindowsΪOVERLAPPEDƫƵReadFile/WriteFile)
+ * Ҳı乲ļλãֻдֽڶӳԤļ
+ * 󲻿ɸƣʱԶرļ
+ */
+class PositionalFile {
+public:
+	PositionalFile() = default;
+	~PositionalFile();
+
+	PositionalFile(const PositionalFile&) = delete;
+	PositionalFile& operator=(const PositionalFile&) = delete;
+
+	/**
+	 * @brief Ѵڵļ
+	 * @param[in] filename ļ·
+	 * @param[in] writable ǷԶдʽ򿪣Ĭֻ
+	 * @return ɹtrueʧܷfalse
+	 */
+	bool open(const std::string& filename, bool writable = false);
+
+	/**
+	 * @brief رļ
+	 */
+	void close();
+
+	/**
+	 * @brief ָƫƶȡ
+	 * @param[in] offset ļƫ(ֽ)
+	 * @param[out] buffer Ŀ껺
+	 * @param[in] length ȡ(ֽ)
+	 * @return lengthֽڷtrueȡʧܻļڴ֮ǰfalse
+	 */
+	bool readAt(size_t offset, void* buffer, size_t length) const;
+
+	/**
+	 * @brief ָƫд
+	 * @param[in] offset ļƫ(ֽ)
+	 * @param[in] buffer Դ
+	 * @param[in] length д볤(ֽ)
+	 * @return ȫд뷵trueδԶдʽ򿪻дʧܷfalse
+	 * @note дԭļĩβ֮ʱļ֮
+	 */
+	bool writeAt(size_t offset, const void* buffer, size_t length);
+
+	/**
+	 * @brief ļضϻչָС
+	 * @param[in] size µļС(ֽ)
+	 * @return ɹtrue
+	 */
+	bool resize(size_t size);
+
+	/**
+	 * @brief ȡļС
+	 * @return ʱļСwriteAt/resizeıΪıĴС(ֽ)
+	 */
+	size_t size() const { return m_size; }
+
+	/**
+	 * @brief ǷѴ
+	 * @return Ѵ򿪷true
+	 */
+	bool isOpen() const {
+#ifdef _WIN32
+		return m_file != nullptr;
+#else
+		return m_fd >= 0;
+#endif
+	}
+
+private:
+	size_t         m_size = 0;                 ///< ļС(ֽ)
+#ifdef _WIN32
+	void*          m_file = nullptr;           ///< ļ(HANDLE)
+#else
+	int            m_fd = -1;                  ///< ļ
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,258 @@
+#include "Permutation.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+/**
+ * @file Permutation.cpp
+ * @brief ûʵ
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * Կֺʹù̶(FNV-1aSplitMix64)
+ * ׼ʵϸڣ֤ƽ̨һ¡
+ */
+
+using namespace std;
+
+/**
+ * @brief SplitMix64Ϻ
+ * @param[in] x ֵ
+ * @return ɢ64λֵ
+ */
+static inline uint64_t mix64(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * @brief û
+ *
+ * FNV-1aɢкСΪԿ
+ * λȡʹ(2^halfBits)^2 >= domainСֵ
+ *
+ * @param[in] password 
+ * @param[in] domain ûС
+ */
+FeistelPermutation::FeistelPermutation(const std::string& password, uint64_t domain)
+	: m_domain(domain), m_halfBits(1), m_halfMask(1)
+{
+	// λ
+	int bits = 0;
+	while (bits < 64 && (domain - 1) >> bits) ++bits;
+	m_halfBits = (bits + 1) / 2;
+	if (m_halfBits < 1) m_halfBits = 1;
+	m_halfMask = (1ULL << m_halfBits) - 1;
+
+	// FNV-1aɢ
+	uint64_t h = 0xCBF29CE484222325ULL;
+	for (unsigned char c : password) {
+		h ^= c;
+		h *= 0x100000001B3ULL;
+	}
+
+	// Կ
+	uint64_t state = h ^ mix64(domain);
+	for (int i = 0; i < kRounds; ++i) {
+		state = mix64(state);
+		m_keys[i] = state;
+	}
+}
+
+/**
+ * @brief 2*halfBitsλռִһFeistel
+ * @param[in] x ֵ
+ * @return ֵ
+ */
+uint64_t FeistelPermutation::encrypt(uint64_t x) const
+{
+	uint64_t left = x >> m_halfBits;
+	uint64_t right = x & m_halfMask;
+	for (int i = 0; i < kRounds; ++i) {
+		uint64_t next = left ^ (mix64(right ^ m_keys[i]) & m_halfMask);
+		left = right;
+		right = next;
+	}
+	return (left << m_halfBits) | right;
+}
+
+/**
+ * @brief indexԪصû
+ *
+ * cycle-walkingܽʱܣ
+ * Feistel籾Ϊ˫䣬սԹ˫䡣
+ *
+ * @param[in] index ±
+ * @return û±
+ */
+uint64_t FeistelPermutation::operator()(uint64_t index) const
+{
+	uint64_t x = encrypt(index);
+	while (x >= m_domain) {
+		x = encrypt(x);
+	}
+	return x;
+}
+
+/**
+ * @brief 컺
+ * @param[in] capacityBytes ڴ(ֽ)
+ */
+PermutationCache::PermutationCache(size_t capacityBytes)
+{
+	m_stats.capacityBytes = capacityBytes;
+}
+
+/**
+ * @brief ɴҺλñ
+ *
+ * LSBģʽԭʵֱһ£빹seed_seqmt19937
+ * 0..pixelDataSize-1ִstd::shuffleԪ͸Ϊuint32_tӰҽ
+ * ΪshuffleĽֻȡгȡ
+ *
+ * @param[in] password 
+ * @param[in] pixelDataSize λñ
+ * @return ɵλñ
+ */
+PermutationCache::PositionsPtr PermutationCache::generate(const std::string& password, size_t pixelDataSize)
+{
+	shared_ptr<Positions> positions = make_shared<Positions>(pixelDataSize);
+	iota(positions->begin(), positions->end(), 0u);
+
+	std::seed_seq seq(password.begin(), password.end());
+	mt19937 rng(seq);
+	shuffle(positions->begin(), positions->end(), rng);
+	return positions;
+}
+
+/**
+ * @brief ȡλñδʱ
+ *
+ * δʱȵǼһδĿͷɣ
+ * ڼ̶߳ͬһȴýظɡ
+ * ʧʱ׳쳣(std::bad_alloc)ȴյͬһ쳣
+ *
+ * @param[in] password 
+ * @param[in] pixelDataSize ݴС
+ * @param[in] bitCount ͼλ
+ * @return λñĹָ
+ */
+PermutationCache::PositionsPtr PermutationCache::acquire(const std::string& password,
+	size_t pixelDataSize, int bitCount)
+{
+	string key = to_string(pixelDataSize) + ':' + to_string(bitCount) + ':' + password;
+	size_t bytes = pixelDataSize * sizeof(uint32_t);
+
+	unique_lock<mutex> lock(m_mutex);
+	auto it = m_entries.find(key);
+	if (it != m_entries.end()) {
+		++m_stats.hits;
+		m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+		shared_future<PositionsPtr> value = it->second.value;
+		lock.unlock();
+		return value.get();
+	}
+
+	++m_stats.misses;
+	if (bytes > m_stats.capacityBytes) {
+		// λñޣ뻺
+		lock.unlock();
+		return generate(password, pixelDataSize);
+	}
+
+	// ǼδĿ
+	promise<PositionsPtr> pending;
+	m_lru.push_front(key);
+	Entry& entry = m_entries[key];
+	entry.value = pending.get_future().share();
+	entry.lruPos = m_lru.begin();
+	lock.unlock();
+
+	PositionsPtr result;
+	try {
+		result = generate(password, pixelDataSize);
+	}
+	catch (...) {
+		// ʧ(ͨΪڴ治)Ŀ֪ͨȴ
+		pending.set_exception(current_exception());
+		lock.lock();
+		auto failed = m_entries.find(key);
+		if (failed != m_entries.end()) {
+			m_lru.erase(failed->second.lruPos);
+			m_entries.erase(failed);
+		}
+		throw;
+	}
+	pending.set_value(result);
+
+	lock.lock();
+	it = m_entries.find(key);
+	if (it != m_entries.end() && it->second.bytes == 0) {
+		it->second.bytes = bytes;
+		m_stats.bytes += bytes;
+		evictLocked();
+	}
+	return result;
+}
+
+/**
+ * @brief LRU˳̭Ŀֱڴ
+ * @note ÷m_mutexеĿ(bytesΪ0)Ҳ̭
+ */
+void PermutationCache::evictLocked()
+{
+	auto it = m_lru.end();
+	while (m_stats.bytes > m_stats.capacityBytes && it != m_lru.begin()) {
+		--it;
+		auto entry = m_entries.find(*it);
+		if (entry->second.bytes == 0) continue;
+
+		m_stats.bytes -= entry->second.bytes;
+		++m_stats.evictions;
+		m_entries.erase(entry);
+		it = m_lru.erase(it);
+	}
+	m_stats.entries = m_entries.size();
+}
+
+/**
+ * @brief ڴޣ̭
+ * @param[in] capacityBytes ڴ(ֽ)
+ */
+void PermutationCache::setCapacity(size_t capacityBytes)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_stats.capacityBytes = capacityBytes;
+	evictLocked();
+}
+
+/**
+ * @brief ջĿ(ͳƼ)
+ * @note еĿɺ
+ */
+void PermutationCache::clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	for (auto it = m_lru.begin(); it != m_lru.end();) {
+		auto entry = m_entries.find(*it);
+		if (entry->second.bytes == 0) { ++it; continue; }
+		m_stats.bytes -= entry->second.bytes;
+		m_entries.erase(entry);
+		it = m_lru.erase(it);
+	}
+	m_stats.entries = m_entries.size();
+}
+
+/**
+ * @brief ȡͳϢ
+ * @return ͳϢ
+ */
+PermutationCacheStats PermutationCache::stats() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	PermutationCacheStats snapshot = m_stats;
+	snapshot.entries = m_entries.size();
+	return snapshot;
+}
@@ -0,0 +1,142 @@
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file Permutation.h
+ * @brief û
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ļ˻FeistelİûڶLSBģʽ
+ * ɲλñֱӼiλá
+ * ͬʱṩLSBģʽλñĻ棬ͬһȡظҡ
+ */
+
+ /**
+  * @class FeistelPermutation
+  * @brief [0, domain)ϵԿ˫
+  *
+  * ڸdomainСżλռƽFeistel磬
+  * ʱѭ(cycle-walking)ֱ䣬֤Ϊ˫䡣
+  * ڴռO(1)ֵС4
+  */
+class FeistelPermutation {
+public:
+	/**
+	 * @brief û
+	 * @param[in] password (Կ)
+	 * @param[in] domain ûС0
+	 */
+	FeistelPermutation(const std::string& password, uint64_t domain);
+
+	/**
+	 * @brief indexԪصû
+	 * @param[in] index ±꣬Сdomain
+	 * @return û±꣬λ[0, domain)
+	 */
+	uint64_t operator()(uint64_t index) const;
+
+	/**
+	 * @brief ȡûС
+	 * @return С
+	 */
+	uint64_t domain() const { return m_domain; }
+
+private:
+	static const int kRounds = 6;   ///< Feistel
+
+	uint64_t encrypt(uint64_t x) const;
+
+	uint64_t m_domain;              ///< ûС
+	int      m_halfBits;            ///< λ
+	uint64_t m_halfMask;            ///< 
+	uint64_t m_keys[kRounds];       ///< Կ
+};
+
+/**
+ * @struct PermutationCacheStats
+ * @brief λñͳϢ
+ */
+struct PermutationCacheStats {
+	size_t hits = 0;          ///< д(ȴ߳ɵ)
+	size_t misses = 0;        ///< δд(Ҫ)
+	size_t evictions = 0;     ///< 򳬳ڴޱ̭Ŀ
+	size_t entries = 0;       ///< ǰĿ
+	size_t bytes = 0;         ///< ǰռڴ(ֽ)
+	size_t capacityBytes = 0; ///< ڴ(ֽ)
+};
+
+/**
+ * @class PermutationCache
+ * @brief LSBģʽλñ
+ *
+ * (, ݴС, λ)ΪҺλñ
+ * ɷʽLSBģʽȫһ(seed_seq + mt19937 + shuffle)
+ * ͬͨ빲ͬһλñɶд㷨ˡ
+ * ʹ˳̭޵ĵλñ뻺档̰߳ȫ
+ */
+class PermutationCache {
+public:
+	typedef std::vector<uint32_t> Positions;
+	typedef std::shared_ptr<const Positions> PositionsPtr;
+
+	/**
+	 * @brief 컺
+	 * @param[in] capacityBytes ڴ(ֽ)0ʾû
+	 */
+	explicit PermutationCache(size_t capacityBytes = kDefaultCapacity);
+
+	/**
+	 * @brief ȡλñδʱ
+	 * @param[in] password ()
+	 * @param[in] pixelDataSize ݴС(λñ)
+	 * @param[in] bitCount ͼλ
+	 * @return λñĹָ룬̭Ӱȡõָ
+	 */
+	PositionsPtr acquire(const std::string& password, size_t pixelDataSize, int bitCount);
+
+	/**
+	 * @brief ڴޣ̭
+	 * @param[in] capacityBytes ڴ(ֽ)
+	 */
+	void setCapacity(size_t capacityBytes);
+
+	/**
+	 * @brief ջĿ(ͳƼ)
+	 */
+	void clear();
+
+	/**
+	 * @brief ȡͳϢ
+	 * @return ͳϢ
+	 */
+	PermutationCacheStats stats() const;
+
+	static const size_t kDefaultCapacity = 512u * 1024u * 1024u; ///< Ĭڴ512MB
+
+private:
+	struct Entry {
+		std::shared_future<PositionsPtr> value;  ///< λñ(ʱΪδ״̬)
+		std::list<std::string>::iterator lruPos; ///< LRUеλ
+		size_t bytes = 0;                        ///< ռڴ棬ǰΪ0
+	};
+
+	static PositionsPtr generate(const std::string& password, size_t pixelDataSize);
+	void evictLocked();
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, Entry> m_entries;
+	std::list<std::string> m_lru;                ///< ͷΪʹ
+	PermutationCacheStats m_stats;
+};
+
+#endif // PERMUTATION_H
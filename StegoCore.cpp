@@ -1,11 +1,18 @@
 #include "StegoCore.h"
+#include "Permutation.h"
+#include "LsbStats.h"
+#include "MappedFile.h"
+#include "FileSystem.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <random>
-#include <numeric>
 #include <cstring>
 #include <stdexcept>
+#include <future>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
 
 /**
  * @file StegoCore.cpp
@@ -20,66 +27,12 @@
 
 using namespace std;
 
-/**
- * @brief CRC32У256
- *
- * ڿټCRC32УֵԤڶʽ0xEDB88320
- * ÿֵӦһֵֽܵ(0-255)CRC32ּ
- */
-static const uint32_t crcTable[256] = {
-	0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,
-	0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
-	0x1DB71064,0x6AB020F2,0xF3B97148,0x84BE41DE,0x1ADAD47D,0x6DDDE4EB,0xF4D4B551,0x83D385C7,
-	0x136C9856,0x646BA8C0,0xFD62F97A,0x8A65C9EC,0x14015C4F,0x63066CD9,0xFA0F3D63,0x8D080DF5,
-	0x3B6E20C8,0x4C69105E,0xD56041E4,0xA2677172,0x3C03E4D1,0x4B04D447,0xD20D85FD,0xA50AB56B,
-	0x35B5A8FA,0x42B2986C,0xDBBBC9D6,0xACBCF940,0x32D86CE3,0x45DF5C75,0xDCD60DCF,0xABD13D59,
-	0x26D930AC,0x51DE003A,0xC8D75180,0xBFD06116,0x21B4F4B5,0x56B3C423,0xCFBA9599,0xB8BDA50F,
-	0x2802B89E,0x5F058808,0xC60CD9B2,0xB10BE924,0x2F6F7C87,0x58684C11,0xC1611DAB,0xB6662D3D,
-	0x76DC4190,0x01DB7106,0x98D220BC,0xEFD5102A,0x71B18589,0x06B6B51F,0x9FBFE4A5,0xE8B8D433,
-	0x7807C9A2,0x0F00F934,0x9609A88E,0xE10E9818,0x7F6A0DBB,0x086D3D2D,0x91646C97,0xE6635C01,
-	0x6B6B51F4,0x1C6C6162,0x856530D8,0xF262004E,0x6C0695ED,0x1B01A57B,0x8208F4C1,0xF50FC457,
-	0x65B0D9C6,0x12B7E950,0x8BBEB8EA,0xFCB9887C,0x62DD1DDF,0x15DA2D49,0x8CD37CF3,0xFBD44C65,
-	0x4DB26158,0x3AB551CE,0xA3BC0074,0xD4BB30E2,0x4ADFA541,0x3DD895D7,0xA4D1C46D,0xD3D6F4FB,
-	0x4369E96A,0x346ED9FC,0xAD678846,0xDA60B8D0,0x44042D73,0x33031DE5,0xAA0A4C5F,0xDD0D7CC9,
-	0x5005713C,0x270241AA,0xBE0B1010,0xC90C2086,0x5768B525,0x206F85B3,0xB966D409,0xCE61E49F,
-	0x5EDEF90E,0x29D9C998,0xB0D09822,0xC7D7A8B4,0x59B33D17,0x2EB40D81,0xB7BD5C3B,0xC0BA6CAD,
-	0xEDB88320,0x9ABFB3B6,0x03B6E20C,0x74B1D29A,0xEAD54739,0x9DD277AF,0x04DB2615,0x73DC1683,
-	0xE3630B12,0x94643B84,0x0D6D6A3E,0x7A6A5AA8,0xE40ECF0B,0x9309FF9D,0x0A00AE27,0x7D079EB1,
-	0xF00F9344,0x8708A3D2,0x1E01F268,0x6906C2FE,0xF762575D,0x806567CB,0x196C3671,0x6E6B06E7,
-	0xFED41B76,0x89D32BE0,0x10DA7A5A,0x67DD4ACC,0xF9B9DF6F,0x8EBEEFF9,0x17B7BE43,0x60B08ED5,
-	0xD6D6A3E8,0xA1D1937E,0x38D8C2C4,0x4FDFF252,0xD1BB67F1,0xA6BC5767,0x3FB506DD,0x48B2364B,
-	0xD80D2BDA,0xAF0A1B4C,0x36034AF6,0x41047A60,0xDF60EFC3,0xA867DF55,0x316E8EEF,0x4669BE79,
-	0xCB61B38C,0xBC66831A,0x256FD2A0,0x5268E236,0xCC0C7795,0xBB0B4703,0x220216B9,0x5505262F,
-	0xC5BA3BBE,0xB2BD0B28,0x2BB45A92,0x5CB36A04,0xC2D7FFA7,0xB5D0CF31,0x2CD99E8B,0x5BDEAE1D,
-	0x9B64C2B0,0xEC63F226,0x756AA39C,0x026D930A,0x9C0906A9,0xEB0E363F,0x72076785,0x05005713,
-	0x95BF4A82,0xE2B87A14,0x7BB12BAE,0x0CB61B38,0x92D28E9B,0xE5D5BE0D,0x7CDCEFB7,0x0BDBDF21,
-	0x86D3D2D4,0xF1D4E242,0x68DDB3F8,0x1FDA836E,0x81BE16CD,0xF6B9265B,0x6FB077E1,0x18B74777,
-	0x88085AE6,0xFF0F6A70,0x66063BCA,0x11010B5C,0x8F659EFF,0xF862AE69,0x616BFFD3,0x166CCF45,
-	0xA00AE278,0xD70DD2EE,0x4E048354,0x3903C2,0xA7672661,0xD06016F7,0x4969474D,0x3E6E77DB,
-	0xAED16A4A,0xD9D65ADC,0x40DF0B66,0x37D83BF0,0xA9BCAE53,0xDEBB9EC5,0x47B2CF7F,0x30B5FFE9,
-	0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,
-	0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D
-};
-
-/**
- * @brief ݵCRC32Уֵ
- *
- * ʹñ׼CRC32㷨ݻУֵ֤ԡ
- *
- * @param[in] buffer ݻ
- * @param[in] length ݳ(ֽ)
- * @return 32λCRCУֵ
- */
-uint32_t StegoCore::calcCRC32(const char* buffer, size_t length) const
-{
-	uint32_t crc = 0xFFFFFFFF; // ʼֵ
-	for (size_t i = 0; i < length; ++i) {
-		// CRC32
-		unsigned char idx = static_cast<unsigned char>((crc ^ buffer[i]) & 0xFF);
-		crc = (crc >> 8) ^ crcTable[idx];
-	}
-	return crc ^ 0xFFFFFFFF; // ֵ
-}
+const size_t StegoCore::kBlockSize;
+const size_t StegoCore::kStreamChunkSize;
+const size_t StegoCore::kDefaultMaxSegments;
+const size_t StegoCarrier::kMinParallelBits;
+const int CoverCapacity::kModes;
+const int CoverCapacity::kMasks;
 
 /**
  * @brief ʹԻXOR/
@@ -90,593 +43,3150 @@ uint32_t StegoCore::calcCRC32(const char* buffer, size_t length) const
  * @param[in,out] buffer (ԭ޸)
  * @param[in] length (ֽ)
  * @param[in] password (ʱִв)
+ * @param[in] offset еʼƫ
  */
-void StegoCore::xorEncryptBuffer(char* buffer, size_t length, const std::string& password) const
+void StegoCore::xorEncryptBuffer(char* buffer, size_t length, const std::string& password, size_t offset) const
 {
 	if (password.empty() || length == 0) return;
 
 	size_t plen = password.size();
+	size_t k = offset % plen;
 	for (size_t i = 0; i < length; ++i) {
 		// ѭʹַXOR
-		buffer[i] ^= password[i % plen];
+		buffer[i] ^= password[k];
+		if (++k == plen) k = 0;
 	}
 }
 
 /**
- * @brief BMPͼд
- *
- * ͼߴ硢ͨдģʽ
- *
- * @param[in] bmp BMPͼ
- * @param[in] ctx дĲ
- * @return (ֽ)Ѽȥ16ֽͷ
+ * @brief ждǷʹв
+ * @param[in] ctx д
+ * @return ˳/ǿģʽѡвʱtrue
  */
-size_t StegoCore::calculateCapacity(const BmpImage& bmp, const StegoContext& ctx) const
+static bool usesRowLayout(const StegoContext& ctx)
 {
-	// ͼʽǷ֧(֧24λ32λ)
-	int bpp = bmp.getBitCount();
-	if (bpp != 24 && bpp != 32) return 0;
-
-	int channels = bpp / 8;
-	size_t dataSize = bmp.getPixelDataSize();
-	if (dataSize == 0) return 0;
-
-	// ʵʹõͨ
-	int used = 0;
-	if (ctx.channelMask & 0x01) ++used; // ɫͨ
-	if (ctx.channelMask & 0x02) ++used; // ɫͨ
-	if (ctx.channelMask & 0x04) ++used; // ɫͨ
-
-	// ģʽȷÿͨʹõλ
-	int bitsPer = (ctx.mode == LSB_ENHANCED) ? 2 : 1;
-
-	// 
-	size_t pixels = dataSize / channels;
-	size_t totalBits = pixels * used * bitsPer;
-	size_t bytes = totalBits / 8;
-
-	// ȥͷСʵʿ
-	return (bytes >= sizeof(StegoHeader)) ? (bytes - sizeof(StegoHeader)) : 0;
+	return ctx.layout == STEGO_LAYOUT_ROWS &&
+		(ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED);
 }
 
 /**
- * @brief صBMPͼ
+ * @brief жϰĳһֶͷǷЧڸò
  *
- * ʵдҪ̣
- * 1. ֤ݳȺͼ
- * 2. ׼дͷϢ
- * 3. ݽмܴ
- * 4. дģʽӦд뺯
+ * ͷвֱ־ȡõĲһ£
+ * ֲǡغϵǰֽС
  *
- * @param[in,out] bmp ѼصBMPͼ(޸)
- * @param[in] data ݵָֻ
- * @param[in] length ݳ(ֽ)
- * @param[in] ctx дĲ
- * @return ɹtrueʧܷfalse
+ * @param[in] header ͷ
+ * @param[in] rowLayout ȡõĲǷΪв
+ * @param[in] checkSignature Ƿħʶ
+ * @return Чtrue
  */
-bool StegoCore::hideData(BmpImage& bmp, const char* data, size_t length, const StegoContext& ctx)
+static bool headerMatchesLayout(const StegoHeader& header, bool rowLayout, bool checkSignature)
 {
-	// ֤ݳ
-	if (length == 0 || length > numeric_limits<uint32_t>::max()) {
-		cerr << "[] ݳȲϷ: " << length << " ֽ" << endl;
-		return false;
-	}
+	if (checkSignature && memcmp(header.signature, "STEG", 4) != 0) return false;
+	if (header.stegoMode & ~(STEGO_FMT_MODE_MASK | STEGO_FMT_KNOWN_FLAGS)) return false;
+	if ((header.stegoMode & STEGO_FMT_CHECKSUM_MASK) == STEGO_FMT_CHECKSUM_MASK) return false;
+	return ((header.stegoMode & STEGO_FMT_ROW_LAYOUT) != 0) == rowLayout;
+}
 
-	// Ƿ㹻
-	size_t cap = calculateCapacity(bmp, ctx);
-	if (length > cap) {
-		cerr << "[] : Ҫ " << length << " ֽڣ  " << cap << " ֽ" << endl;
-		return false;
+/**
+ * @brief ȡУ㷨Ӧͷʽ־
+ * @param[in] type У㷨
+ * @return ʽ־ԭвCRC32Ϊ0
+ */
+static uint16_t checksumFlag(ChecksumType type)
+{
+	switch (type) {
+	case CHECKSUM_CRC32:  return STEGO_FMT_CRC32;
+	case CHECKSUM_CRC32C: return STEGO_FMT_CRC32C;
+	default:              return 0;
 	}
+}
 
-	// ׼дͷ
-	StegoHeader header;
-	memcpy(header.signature, "STEG", 4);           // ħʶ
-	header.dataLength = static_cast<uint32_t>(length);
-	header.stegoMode = ctx.mode;
-	header.channelMask = ctx.channelMask;
-	header.crc32Value = calcCRC32(data, length);   // ԭʼУֵ
-
-	// Ʋ
-	vector<char> buf(data, data + length);
-	xorEncryptBuffer(buf.data(), length, ctx.password);
+/**
+ * @brief ȡͷ¼У㷨
+ * @param[in] header ͨheaderMatchesLayoutͷ
+ * @return У㷨
+ */
+static ChecksumType headerChecksum(const StegoHeader& header)
+{
+	if (header.stegoMode & STEGO_FMT_CRC32) return CHECKSUM_CRC32;
+	if (header.stegoMode & STEGO_FMT_CRC32C) return CHECKSUM_CRC32C;
+	return CHECKSUM_LEGACY;
+}
 
-	// дͷͼܺ
-	return writeAll(bmp, header, buf.data(), length, ctx);
+/**
+ * @brief ȡдʵʹõ߳
+ * @param[in] ctx д
+ * @return ߳Ϊ1
+ */
+static size_t resolveThreads(const StegoContext& ctx)
+{
+	return ctx.threads ? ctx.threads : ThreadPool::hardwareThreads();
 }
 
 /**
- * @brief BMPͼȡ
- *
- * ʵȡҪ̣
- * 1. ԶȡдͷϢ
- * 2. ֤ͷЧ
- * 3. ȡ
- * 4. ֤
+ * @brief ԭвְݴС²ͨ
  *
- * ֧Զģʽ᳢Զдģʽͨϡ
+ * ݴСܱ4Ϊ4ͨгΪ4ֽڱ24λͼҲ4ͨ
+ * 뱣ֲԼдͼ
  *
- * @param[in] bmp ѼصBMPͼ(ֻ)
- * @param[out] outData ݻָ(delete[])
- * @param[out] outLength ʵʳ
- * @param[in,out] ctx д(autoDetect=trueʱmodechannelMask)
- * @return ɹtrueʧܷfalse
+ * @param[in] dataSize ݴС
+ * @return 34
  */
-bool StegoCore::extractData(const BmpImage& bmp, char*& outData, size_t& outLength, StegoContext& ctx)
+static int legacyChannels(size_t dataSize)
 {
-	// ʼ
-	outData = nullptr;
-	outLength = 0;
-
-	// ȷҪԵģʽͨ
-	vector<SteganoMode> modes;
-	vector<uint16_t>    masks;
+	return (dataSize % 4 == 0 && dataSize / 4 > 0) ? 4 : 3;
+}
 
-	if (ctx.autoDetect) {
-		// Զģʽпܵģʽͨ
-		modes = { LSB_SEQUENTIAL, LSB_ENHANCED, LSB_RANDOM };
-		masks = { 0x01,0x02,0x04,0x03,0x05,0x06,0x07 }; // пܵͨ
+/**
+ * @brief ȡĳһ°洢˳еЧֽڶ
+ *
+ * вȡƽͼĸЧֽڣԭвְ²ͨΪһΡ
+ *
+ * @param[in] info Ϣͷ
+ * @param[in] dataSize ݴС
+ * @param[in] layout 岼
+ * @param[out] channels ÿֽ
+ * @param[out] runs Чֽڶ
+ * @return òֿʱtrue
+ */
+static bool layoutRuns(const BmpInfoHeader& info, size_t dataSize, StegoLayout layout,
+	int& channels, vector<BmpByteRun>& runs)
+{
+	runs.clear();
+	if (dataSize == 0) return false;
+	if (layout == STEGO_LAYOUT_ROWS) {
+		BmpPlaneView view = BmpImage::planeViewOf(info, dataSize);
+		if (!view.valid()) return false;
+		channels = view.channels;
+		runs = move(view.runs);
 	}
 	else {
-		// ָģʽûָģʽͨ
-		modes = { ctx.mode };
-		masks = { ctx.channelMask };
+		channels = legacyChannels(dataSize);
+		runs.push_back(BmpByteRun{ 0, dataSize });
 	}
+	return true;
+}
 
-	// пܵģʽͨ
-	for (auto m : modes) {
-		for (auto mask : masks) {
-			// Զȡͷ
-			StegoHeader hdr;
-			if (!readHeader(bmp, hdr, m, mask, ctx.password, true)) continue;
-
-			// ֤ݳȺ
-			if (hdr.dataLength == 0 || hdr.dataLength > 100 * 1024 * 1024) continue;
-
-			// ڴ
-			size_t len = hdr.dataLength;
-			char* buf = nullptr;
-			try {
-				buf = new char[len];
-			}
-			catch (...) {
-				cerr << "[] ڴʧ: " << len << " ֽ" << endl;
-				continue;
-			}
-
-			// ȡݲ
-			if (!readDataSection(bmp, hdr, buf, len, m, mask, ctx.password)) {
-				delete[] buf;
-				continue;
-			}
-
-			// 
-			xorEncryptBuffer(buf, len, ctx.password);
-
-			// ֤CRC32Уֵ
-			if (calcCRC32(buf, len) != hdr.crc32Value) {
-				delete[] buf;
-				continue;
-			}
-
-			// ȡɹ
-			outData = buf;
-			outLength = len;
-			ctx.mode = static_cast<SteganoMode>(hdr.stegoMode);
-			ctx.channelMask = hdr.channelMask;
-			return true;
-		}
+/**
+ * @brief ͷݿͷ
+ *
+ * 1λͨʱÿֻ1λҪͷλء
+ *
+ * @param[in] channels ÿֽ
+ * @param[in] runs Чֽڶ
+ * @return ֽ
+ */
+static size_t headerSpan(int channels, const vector<BmpByteRun>& runs)
+{
+	size_t want = sizeof(StegoHeader) * 8;
+	size_t end = 0;
+	for (const BmpByteRun& run : runs) {
+		size_t take = min(run.length / channels, want);
+		end = run.offset + take * channels;
+		want -= take;
+		if (want == 0) break;
 	}
+	return end;
+}
 
-	// гԶʧ
-	if (!ctx.autoDetect) {
-		cerr << "[] ȡʧܣû" << endl;
+/**
+ * @brief дָֽʱб޸ĵķΧ
+ *
+ * ˳/ǿģʽ㰴ռãλðÿسصλȡأ
+ * ģʽλ÷ֲУ鳤ȡ
+ *
+ * @param[in] info Ϣͷ
+ * @param[in] dataSize ݴС(ֽ)
+ * @param[in] mode дģʽ
+ * @param[in] mask ͨ
+ * @param[in] layout 岼
+ * @param[in] bytes дֽ(ͷ)
+ * @return ޸ĵֽ
+ */
+static size_t embedSpan(const BmpInfoHeader& info, size_t dataSize, SteganoMode mode, uint16_t mask,
+	StegoLayout layout, size_t bytes)
+{
+	if (mode != LSB_SEQUENTIAL && mode != LSB_ENHANCED) return dataSize;
+	int channels = 0;
+	vector<BmpByteRun> runs;
+	if (!layoutRuns(info, dataSize, layout, channels, runs)) return dataSize;
+
+	size_t bitsPerPixel = 0;
+	for (int ch = 0; ch < channels; ++ch) bitsPerPixel += (mask >> ch) & 0x01;
+	bitsPerPixel *= (mode == LSB_ENHANCED) ? 2 : 1;
+	if (bitsPerPixel == 0) return dataSize;
+
+	size_t want = (bytes * 8 + bitsPerPixel - 1) / bitsPerPixel;
+	size_t end = 0;
+	for (const BmpByteRun& run : runs) {
+		size_t take = min(run.length / channels, want);
+		end = run.offset + take * channels;
+		want -= take;
+		if (want == 0) return end;
 	}
-	return false;
+	return dataSize;
 }
 
 /**
- * @brief дд(ͷ+)
+ * @brief Ǽдλ[firstByte, firstByte+bytes)ʱ޸ĵݷΧ
  *
- * дģʽѡӦд㷨ͷдͼ
+ * ˳/ǿģʽؿǰݹãȡصλûһ(4ֽ)
+ * ģʽǼݡ
  *
  * @param[in,out] bmp BMPͼ
- * @param[in] header дͷṹ
- * @param[in] data (Ѽ)
- * @param[in] length ݳ
- * @param[in] ctx д
- * @return ɹtrueʧܷfalse
+ * @param[in] ctx д(ʹmodechannelMasklayout)
+ * @param[in] firstByte λеʼֽ(дͷ)
+ * @param[in] bytes дֽ
  */
-bool StegoCore::writeAll(BmpImage& bmp, const StegoHeader& header,
-	const char* data, size_t length, const StegoContext& ctx)
+static void markEmbedded(BmpImage& bmp, const StegoContext& ctx, size_t firstByte, size_t bytes)
 {
-	// ׼ݻ(ͷ+)
-	size_t total = sizeof(header) + length;
-	vector<char> fullBuf(total);
-	memcpy(fullBuf.data(), &header, sizeof(header));
-	memcpy(fullBuf.data() + sizeof(header), data, length);
-
-	// ȡ
-	unsigned char* pixels = bmp.getPixelData();
-	size_t pdSize = bmp.getPixelDataSize();
-
-	// ģʽȷÿͨʹõλ
-	int bitsPer = (ctx.mode == LSB_ENHANCED) ? 2 : 1;
-	if (ctx.mode == LSB_RANDOM) bitsPer = 1;
-
-	// ģʽѡд㷨
-	bool ok = false;
-	if (ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED) {
-		// ˳ģʽǿģʽ
-		ok = writeSequentialLSB(pixels, pdSize, fullBuf.data(), total, ctx.channelMask, bitsPer);
-	}
-	else {
-		// ģʽ
-		ok = writeRandomLSB(pixels, pdSize, fullBuf.data(), total, ctx.channelMask, 1, ctx.password, 0);
+	const BmpInfoHeader& info = bmp.infoHeader();
+	size_t dataSize = bmp.getPixelDataSize();
+	StegoLayout layout = usesRowLayout(ctx) ? STEGO_LAYOUT_ROWS : STEGO_LAYOUT_LEGACY;
+	size_t end = embedSpan(info, dataSize, ctx.mode, ctx.channelMask, layout, firstByte + bytes);
+	size_t begin = 0;
+	if (firstByte > 0 && (ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED)) {
+		begin = embedSpan(info, dataSize, ctx.mode, ctx.channelMask, layout, firstByte);
+		begin -= min<size_t>(begin, 4);
 	}
+	bmp.markDirty(begin, end - begin);
+}
 
-	if (!ok) {
-		cerr << "[] ддʧ" << endl;
+/**
+ * @brief ռ忪ͷԽͷλƽ
+ * @param[in] pixels ݿͷ
+ * @param[in] available pixelsпõֵֽֽڶαض
+ * @param[in] channels ÿֽ
+ * @param[in] runs Чֽڶ
+ * @param[out] planes λƽ
+ */
+static void collectHeaderPlanes(const unsigned char* pixels, size_t available, int channels,
+	const vector<BmpByteRun>& runs, LsbPlanes& planes)
+{
+	const size_t maxPixels = sizeof(StegoHeader) * 8;
+	planes.channels = channels;
+	for (const BmpByteRun& run : runs) {
+		if (planes.pixels >= maxPixels || run.offset >= available) break;
+		lsbAppendPlanes(planes, pixels + run.offset, min(run.length, available - run.offset), maxPixels);
 	}
-	return ok;
 }
 
 /**
- * @brief ȡдͷϢ
+ * @brief 忪ͷͨ˳Ƕĸ
  *
- * ʹָģʽͨͼжȡдͷ
+ * ڴkFirstWindow4ɿͷֵԿ飬ÿͨȡеֵ
+ * ʹ̲ͬǶ붼䳤Ĵ(ԶǶ볤ʱδǶ벿ֻϡͳ)
+ * СΪͨ1λʱͷռõֻͷǶҲ֮൱Ĵڡ
+ * вͳƣԭвְ²ͨΪһΡ
  *
  * @param[in] bmp BMPͼ
- * @param[out] headerOut ͷṹ
- * @param[in] modeToTry Եдģʽ
- * @param[in] channelMaskToTry Եͨ
- * @param[in] password 
- * @param[in] checkSignature Ƿħʶ
- * @return ɹtrueʧܷfalse
+ * @param[in] layout 岼
+ * @param[out] scores ͨǶ(0~1)޷ͳʱΪ1
  */
-bool StegoCore::readHeader(const BmpImage& bmp, StegoHeader& headerOut,
-	SteganoMode modeToTry, uint16_t channelMaskToTry,
-	const std::string& password, bool checkSignature) const
+static void leadingEmbedScores(const BmpImage& bmp, StegoLayout layout, double scores[4])
 {
-	// ׼ͷ
-	vector<char> buf(sizeof(StegoHeader), 0);
-	const unsigned char* pixels = bmp.getPixelData();
-	size_t pdSize = bmp.getPixelDataSize();
-	if (pdSize == 0) return false;
-
-	// ģʽȷÿͨʹõλ
-	int bitsPer = (modeToTry == LSB_ENHANCED) ? 2 : 1;
-	if (modeToTry == LSB_RANDOM) bitsPer = 1;
-
-	// ģʽѡȡ㷨
-	bool ok = false;
-	if (modeToTry == LSB_SEQUENTIAL || modeToTry == LSB_ENHANCED) {
-		// ˳ģʽǿģʽ
-		ok = readSequentialLSB(pixels, pdSize, buf.data(), buf.size(), channelMaskToTry, bitsPer);
-	}
-	else {
-		// ģʽ
-		ok = readRandomLSB(pixels, pdSize, buf.data(), buf.size(), channelMaskToTry, 1, password, 0);
-	}
-	if (!ok) return false;
-
-	// ͷ
-	memcpy(&headerOut, buf.data(), sizeof(StegoHeader));
+	const size_t kFirstWindow = sizeof(StegoHeader) * 8;
+	const size_t kLastWindow = 128 * 1024;
+	for (int ch = 0; ch < 4; ++ch) scores[ch] = 1.0;
 
-	// ֤ħʶ
-	if (checkSignature && memcmp(headerOut.signature, "STEG", 4) != 0) {
-		return false;
+	const unsigned char* pixels = bmp.getPixelData();
+	vector<BmpByteRun> runs;
+	int channels = 0;
+	if (!pixels || !layoutRuns(bmp.infoHeader(), bmp.getPixelDataSize(), layout, channels, runs)) return;
+
+	LsbHistogram hist[4] = {};
+	size_t done = 0;
+	size_t run = 0;
+	size_t offset = 0;
+	for (int ch = 0; ch < channels; ++ch) scores[ch] = 0.0;
+	for (size_t window = kFirstWindow; window <= kLastWindow; window *= 4) {
+		// ΰֻۼ
+		while (done < window && run < runs.size()) {
+			size_t avail = (runs[run].length - offset) / channels;
+			size_t take = min(avail, window - done);
+			lsbAccumulateHistograms(pixels + runs[run].offset + offset, take * channels, channels, hist);
+			done += take;
+			offset += take * channels;
+			if (take == avail) { ++run; offset = 0; }
+		}
+		for (int ch = 0; ch < channels; ++ch) scores[ch] = max(scores[ch], lsbPairsOfValues(hist[ch]));
+		if (done < window) break;
 	}
-	return true;
 }
 
 /**
- * @brief ȡдݲ
+ * @brief BMPͼд
  *
- * ֪ͷϢͼжȡдݲ֡
+ * ͼߴ硢ͨдģʽ
  *
  * @param[in] bmp BMPͼ
- * @param[in] header Ѷȡдͷ
- * @param[out] dataOut ݻ
- * @param[in] length Ҫȡݳ
- * @param[in] modeToTry Եдģʽ
- * @param[in] channelMaskToTry Եͨ
- * @param[in] password 
- * @return ɹtrueʧܷfalse
+ * @param[in] ctx дĲ
+ * @return (ֽ)Ѽȥ16ֽͷ
  */
-bool StegoCore::readDataSection(const BmpImage& bmp, const StegoHeader& header,
-	char* dataOut, size_t length,
-	SteganoMode modeToTry, uint16_t channelMaskToTry,
-	const std::string& password) const
+size_t StegoCore::calculateCapacity(const BmpImage& bmp, const StegoContext& ctx) const
 {
-	const unsigned char* pixels = bmp.getPixelData();
-	size_t pdSize = bmp.getPixelDataSize();
-	if (length == 0) return true;
-	if (pdSize == 0) return false;
-
-	// ģʽȷÿͨʹõλ
-	int bitsPer = (modeToTry == LSB_ENHANCED) ? 2 : 1;
-	if (modeToTry == LSB_RANDOM) bitsPer = 1;
-
-	if (modeToTry == LSB_SEQUENTIAL || modeToTry == LSB_ENHANCED) {
-		// ˳ǿģʽȡͷڵ飬Ȼȡݲ
-		size_t totalBytesToRead = sizeof(StegoHeader) + length;
-
-		// ȡ(ͷ+)
-		vector<char> fullBuf(totalBytesToRead);
-		if (!readSequentialLSB(pixels, pdSize, fullBuf.data(), totalBytesToRead, channelMaskToTry, bitsPer))
-			return false;
-
-		// ȡݲ
-		memcpy(dataOut, fullBuf.data() + sizeof(StegoHeader), length);
-		return true;
-	}
-	else { // LSB_RANDOM
-		// ģʽȡͷڵ飬Ȼȡݲ
-		size_t totalBytesToRead = sizeof(StegoHeader) + length;
-
-		// ȡ(ͷ+)
-		vector<char> fullBuffer(totalBytesToRead);
-		// еĿͷ(offsetBits=0)ʼȡ
-		if (!readRandomLSB(pixels, pdSize, fullBuffer.data(), totalBytesToRead, channelMaskToTry, 1, password, 0)) {
-			return false;
-		}
+	return calculateCapacity(bmp.infoHeader(), bmp.getPixelDataSize(), ctx);
+}
 
-		// ȡݲ
-		memcpy(dataOut, fullBuffer.data() + sizeof(StegoHeader), length);
-		return true;
-	}
+/**
+ * @brief ֿУʽĿС
+ * @param[in] length ݳ(ֽ)
+ * @param[in] chunkSize С(ֽ)
+ * @return StegoChunkTableУֵֽ
+ */
+static size_t chunkTableSize(size_t length, size_t chunkSize)
+{
+	return sizeof(StegoChunkTable) + (length + chunkSize - 1) / chunkSize * sizeof(uint32_t);
 }
 
 /**
- * @brief ˳LSBд㷨
+ * @brief ۳Ŀ
  *
- * ˳λдصЧλ
+ * ÿռchunkSize4ֽУֵʣռ䳬4ֽʱһĩ顣
  *
- * @param[in,out] pixelData ݻ
- * @param[in] pixelDataSize ݴС
- * @param[in] src Դݻ
- * @param[in] numBytes Ҫдֽ
- * @param[in] channelMask ͨ
- * @param[in] bitsPerChannel ÿͨʹõλ(12)
- * @return ɹtrueʧܷfalse
+ * @param[in] avail ͷ֮Ŀֽ
+ * @param[in] chunkSize С(ֽ)
+ * @return ݳ(ֽ)
  */
-bool StegoCore::writeSequentialLSB(unsigned char* pixelData, size_t pixelDataSize,
-	const char* src, size_t numBytes,
-	uint16_t channelMask, int bitsPerChannel) const
+static size_t chunkedCapacity(size_t avail, size_t chunkSize)
 {
-	if (numBytes == 0) return true;
-	if ((bitsPerChannel != 1 && bitsPerChannel != 2) || pixelDataSize == 0) return false;
-
-	// ²ͼͨ
-	int bitCount = (pixelDataSize % 4 == 0 && pixelDataSize / 4 > 0) ? 32 : 24;
-	int channels = bitCount / 8;
-
-	// ʼ
-	size_t totalBits = numBytes * 8;
-	size_t bitsWritten = 0;
-	size_t srcByte = 0;
-	int srcBit = 0;
-	size_t pixByte = 0;
-
-	// λд
-	while (bitsWritten < totalBits && pixByte < pixelDataSize) {
-		int ch = pixByte % channels;  // ǰͨ
-
-		// 鵱ǰͨǷ
-		if ((channelMask >> ch) & 0x01) {
-			unsigned char bits = 0;
-
-			// ռҪдλ
-			for (int i = 0; i < bitsPerChannel && bitsWritten < totalBits; ++i) {
-				int v = (src[srcByte] >> (7 - srcBit)) & 0x01;
-				bits = (bits << 1) | v;
-				++srcBit;
-				if (srcBit == 8) { srcBit = 0; ++srcByte; }
-				++bitsWritten;
-			}
+	if (avail <= sizeof(StegoChunkTable)) return 0;
+	avail -= sizeof(StegoChunkTable);
+	size_t full = avail / (chunkSize + sizeof(uint32_t));
+	size_t rest = avail - full * (chunkSize + sizeof(uint32_t));
+	return full * chunkSize + (rest > sizeof(uint32_t) ? rest - sizeof(uint32_t) : 0);
+}
 
-			// дλ
-			if (bitsPerChannel == 1) {
-				// 1λLSBģʽ滻λ
-				pixelData[pixByte] = (pixelData[pixByte] & 0xFE) | (bits & 0x01);
-			}
-			else {
-				// 2λLSBģʽ滻λ
-				pixelData[pixByte] = (pixelData[pixByte] & 0xFC) | (bits & 0x03);
-			}
-		}
-		++pixByte;
+/**
+ * @brief ׷һ𻵷Χһʱϲ
+ * @param[in,out] ranges ƫƵķΧб
+ * @param[in] offset ʼƫ
+ * @param[in] length 
+ */
+static void appendRange(vector<StegoByteRange>& ranges, size_t offset, size_t length)
+{
+	if (!ranges.empty() && ranges.back().offset + ranges.back().length == offset) {
+		ranges.back().length += length;
+	}
+	else {
+		ranges.push_back(StegoByteRange{ offset, length });
 	}
-
-	// Ƿдλ
-	return bitsWritten == totalBits;
 }
 
 /**
- * @brief ˳LSBȡ㷨
+ * @brief һڸֿĲһô
  *
- * ˳صЧλȡλ
+ * һݿܿԽֿ飬ֻص̳߳ʱд
  *
- * @param[in] pixelData ݻ
- * @param[in] pixelDataSize ݴС
- * @param[out] dst Ŀݻ
- * @param[in] numBytes Ҫȡֽ
- * @param[in] channelMask ͨ
- * @param[in] bitsPerChannel ÿͨʹõλ(12)
- * @return ɹtrueʧܷfalse
+ * @param[in] offset ÿеƫ
+ * @param[in] n ÿݳ
+ * @param[in] chunkSize ֿС
+ * @param[in] pool ̳߳أΪ
+ * @param[in] body Ϊֿšòеƫ볤
  */
-bool StegoCore::readSequentialLSB(const unsigned char* pixelData, size_t pixelDataSize,
-	char* dst, size_t numBytes,
-	uint16_t channelMask, int bitsPerChannel) const
+static void forEachChunkPiece(size_t offset, size_t n, size_t chunkSize, ThreadPool* pool,
+	const function<void(size_t chunk, size_t begin, size_t length)>& body)
 {
-	if (numBytes == 0) return true;
-	if ((bitsPerChannel != 1 && bitsPerChannel != 2) || pixelDataSize == 0) return false;
-
-	// ²ͼͨ
-	int bitCount = (pixelDataSize % 4 == 0 && pixelDataSize / 4 > 0) ? 32 : 24;
-	int channels = bitCount / 8;
-
-	// ʼ
-	size_t totalBits = numBytes * 8;
-	size_t bitsRead = 0;
-	size_t dstByte = 0;
-	int dstBit = 0;
-	size_t pixByte = 0;
-
-	// Ŀ껺
-	memset(dst, 0, numBytes);
-
-	// λȡ
-	while (bitsRead < totalBits && pixByte < pixelDataSize) {
-		int ch = pixByte % channels;  // ǰͨ
-
-		// 鵱ǰͨǷ
-		if ((channelMask >> ch) & 0x01) {
-			// ȡλ
-			unsigned char val = pixelData[pixByte] & ((bitsPerChannel == 1) ? 0x01 : 0x03);
-
-			// ȡλдĿ껺
-			for (int i = bitsPerChannel - 1; i >= 0 && bitsRead < totalBits; --i) {
-				dst[dstByte] |= ((val >> i) & 0x01) << (7 - dstBit);
-				++dstBit; ++bitsRead;
-				if (dstBit == 8) { dstBit = 0; ++dstByte; }
-			}
-		}
-		++pixByte;
+	if (n == 0) return;
+	size_t first = offset / chunkSize;
+	size_t count = (offset + n - 1) / chunkSize - first + 1;
+	auto piece = [&](size_t i) {
+		size_t c = first + i;
+		size_t begin = max(offset, c * chunkSize);
+		size_t end = min(offset + n, (c + 1) * chunkSize);
+		body(c, begin, end - begin);
+	};
+	if (pool && count > 1) {
+		pool->parallelFor(count, piece);
+	}
+	else {
+		for (size_t i = 0; i < count; ++i) piece(i);
 	}
-
-	// Ƿȡλ
-	return bitsRead == totalBits;
 }
 
 /**
- * @brief LSBд㷨
+ * @brief ϢͷݴСд
  *
- * ʹɵαȷдλãǿԡ
+ * ֻͷϢȡݡ
  *
- * @param[in,out] pixelData ݻ
- * @param[in] pixelDataSize ݴС
- * @param[in] src Դݻ
- * @param[in] numBytes Ҫдֽ
- * @param[in] channelMask ͨ
- * @param[in] bitsPerChannel ÿͨʹõλ(ͨΪ1)
- * @param[in] password е
- * @param[in] offsetBits ʼλƫ
- * @return ɹtrueʧܷfalse
+ * @param[in] info Ϣͷ
+ * @param[in] dataSize ݴС(ֽ)
+ * @param[in] ctx дĲ
+ * @return (ֽ)Ѽȥ16ֽͷ
  */
-bool StegoCore::writeRandomLSB(unsigned char* pixelData, size_t pixelDataSize,
-	const char* src, size_t numBytes,
-	uint16_t channelMask, int bitsPerChannel,
-	const std::string& password, size_t offsetBits) const
+size_t StegoCore::calculateCapacity(const BmpInfoHeader& info, size_t dataSize, const StegoContext& ctx) const
 {
-	if (numBytes == 0) return true;
-	if (pixelDataSize == 0) return false;
-	if (password.empty()) return false;
-
-	// λ
-	vector<size_t> positions(pixelDataSize);
-	iota(positions.begin(), positions.end(), 0);  // 0pixelDataSize-1
+	// ͼʽǷ֧(֧24λ32λ)
+	int bpp = info.biBitCount;
+	if (bpp != 24 && bpp != 32) return 0;
 
-	// ʹΪ
-	std::seed_seq seq(password.begin(), password.end());
-	mt19937 rng(seq);
-	shuffle(positions.begin(), positions.end(), rng);  // λ
+	int channels = bpp / 8;
+	if (dataSize == 0) return 0;
 
-	// ʼ
-	size_t totalBits = numBytes * 8;
-	size_t bitsWritten = 0;
-	size_t srcByte = 0;
-	int srcBit = 0;
+	// ģʽ˳/ǿģʽԭвְ²ͨأλһ
+	bool sequential = (ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED);
+	if (ctx.mode == LSB_RANDOM || (sequential && !usesRowLayout(ctx))) channels = legacyChannels(dataSize);
 
-	// ָƫʼλд
-	for (size_t i = offsetBits; bitsWritten < totalBits && i < pixelDataSize; ++i) {
-		size_t idx = positions[i];  // λ
+	// ʵʹõͨ
+	int used = 0;
+	if (ctx.channelMask & 0x01) ++used; // ɫͨ
+	if (ctx.channelMask & 0x02) ++used; // ɫͨ
+	if (ctx.channelMask & 0x04) ++used; // ɫͨ
+
+	// ģʽȷÿͨʹõλ
+	int bitsPer = (ctx.mode == LSB_ENHANCED) ? 2 : 1;
+
+	// (вģʽֻЧأԭвְݼ)
+	size_t pixels = dataSize / channels;
+	if (usesRowLayout(ctx) || ctx.mode == LSB_RANDOM_LAZY) {
+		BmpPlaneView view = BmpImage::planeViewOf(info, dataSize);
+		if (!view.valid()) return 0;
+		pixels = view.pixelCount();
+	}
+	size_t totalBits = pixels * used * bitsPer;
+	size_t bytes = totalBits / 8;
+
+	// ȥͷСʵʿ
+	size_t cap = (bytes >= sizeof(StegoHeader)) ? (bytes - sizeof(StegoHeader)) : 0;
+	return ctx.chunkSize ? chunkedCapacity(cap, ctx.chunkSize) : cap;
+}
+
+/**
+ * @brief ֻȡBMPļͷģʽͨµд
+ * @param[in] filename BMPļ·
+ * @param[out] cover Ϣ
+ * @param[in] ctx дĲ
+ * @return ͷЧΪ24/32λͼʱtrue
+ */
+bool StegoCore::queryCapacity(const std::string& filename, CoverCapacity& cover, const StegoContext& ctx) const
+{
+	cover = CoverCapacity();
+	cover.path = filename;
+
+	PositionalFile file;
+	BmpHeaders headers;
+	if (!file.open(filename) || !BmpImage::readHeaders(file, filename, headers)) return false;
+	file.close();
+
+	cover.width = headers.infoHeader.biWidth;
+	cover.height = headers.infoHeader.biHeight;
+	cover.bitCount = headers.infoHeader.biBitCount;
+	if (cover.bitCount != 24 && cover.bitCount != 32) return false;
+
+	StegoContext candidate = ctx;
+	for (int m = 0; m < CoverCapacity::kModes; ++m) {
+		for (int k = 0; k < CoverCapacity::kMasks; ++k) {
+			candidate.mode = static_cast<SteganoMode>(m);
+			candidate.channelMask = static_cast<uint16_t>(k + 1);
+			cover.capacity[m][k] = calculateCapacity(headers.infoHeader, headers.pixelSize, candidate);
+		}
+	}
+	cover.valid = true;
+	return true;
+}
+
+/**
+ * @brief ͳĿ¼ȫBMPļд
+ *
+ * ļأ̳߳ȡÿļֻ򿪲ȡͷʱҪȡļͼС
+ *
+ * @param[in] directory Ŀ¼·
+ * @param[out] covers ļϢ
+ * @param[in] ctx дĲ
+ * @return Ŀ¼ɴʱtrue
+ */
+bool StegoCore::scanCapacities(const std::string& directory, std::vector<CoverCapacity>& covers,
+	const StegoContext& ctx) const
+{
+	covers.clear();
+	vector<string> paths;
+	if (!listDirectory(directory, ".bmp", paths)) return false;
+
+	covers.resize(paths.size());
+	auto query = [&](size_t i) { queryCapacity(paths[i], covers[i], ctx); };
+	shared_ptr<ThreadPool> pool = (paths.size() > 1) ? acquirePool(resolveThreads(ctx)) : nullptr;
+	if (pool) {
+		pool->parallelFor(paths.size(), query);
+	}
+	else {
+		for (size_t i = 0; i < paths.size(); ++i) query(i);
+	}
+	return true;
+}
+
+/**
+ * @brief صBMPͼ
+ *
+ * ݰkBlockSizeֿ鸴ƵʱhidePayload
+ * ߳ʱС߳Ŵʹÿзֺĸ㹻
+ *
+ * @param[in,out] bmp ѼصBMPͼ(޸)
+ * @param[in] data ݵָֻ
+ * @param[in] length ݳ(ֽ)
+ * @param[in] ctx дĲ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::hideData(BmpImage& bmp, const char* data, size_t length, const StegoContext& ctx)
+{
+	vector<char> block;
+	auto source = [&](size_t offset, size_t n) -> char* {
+		if (block.size() < n) block.resize(n);
+		memcpy(block.data(), data + offset, n);
+		return block.data();
+	};
+	return hidePayload(bmp, length, kBlockSize * resolveThreads(ctx), source, ctx);
+}
+
+/**
+ * @brief ȡݲصBMPͼ
+ *
+ * ʹ黺ȡȡߵǰʱں̷̨߳һĶȡ
+ * ̶ȡ뵱ǰУ顢ܡǶصС
+ *
+ * @param[in,out] bmp ѼصBMPͼ(޸)
+ * @param[in,out] in 
+ * @param[in] length ݳ(ֽ)
+ * @param[in] ctx дĲ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::hideStream(BmpImage& bmp, std::istream& in, size_t length, const StegoContext& ctx)
+{
+	size_t chunk = min(length, kStreamChunkSize);
+	vector<char> buffers[2];
+	future<bool> pending; // ڻ֮ʱȵȴδɵĶȡ
+
+	auto startRead = [&](int slot, size_t n) {
+		char* dst = buffers[slot].data();
+		pending = async(launch::async | launch::deferred, [&in, dst, n]() {
+			in.read(dst, static_cast<streamsize>(n));
+			return static_cast<size_t>(in.gcount()) == n;
+		});
+	};
+
+	int current = 0;
+	auto source = [&](size_t offset, size_t n) -> char* {
+		if (!pending.valid() || !pending.get()) {
+			cerr << "[] ȡʧ: ƫ " << offset << " ֽ" << endl;
+			return nullptr;
+		}
+		char* block = buffers[current].data();
+		current ^= 1;
+		size_t next = offset + n;
+		if (next < length) startRead(current, min(chunk, length - next));
+		return block;
+	};
+
+	try {
+		buffers[0].resize(chunk);
+		buffers[1].resize(chunk);
+		if (chunk > 0) startRead(0, chunk);
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: " << chunk << " ֽ" << endl;
+		return false;
+	}
+	return hidePayload(bmp, length, chunk, source, ctx);
+}
+
+/**
+ * @brief ݵҪ
+ *
+ * 1. ֤ݳȺͼ
+ * 2. дģʽλ
+ * 3. дͷУֵܲǶݣдУֵͷ
+ *
+ * ctx.chunkSizeΪ0ʱдֿУʽ(STEGO_FMT_CHUNKED)ѿ۳
+ *
+ * @param[in,out] bmp ѼصBMPͼ(޸)
+ * @param[in] length ݳ(ֽ)
+ * @param[in] blockSize ÿsourceĿС
+ * @param[in] source ݿԴ
+ * @param[in] ctx дĲ
+ * @param[in] formatFlags дͷĸʽ־(STEGO_FMT_SHARD)
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::hidePayload(BmpImage& bmp, size_t length, size_t blockSize,
+	const PayloadSource& source, const StegoContext& ctx, uint16_t formatFlags)
+{
+	// ֤ݳ
+	if (length == 0 || length > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ݳȲϷ: " << length << " ֽ" << endl;
+		return false;
+	}
+
+	// Ƿ㹻
+	size_t cap = calculateCapacity(bmp, ctx);
+	if (length > cap) {
+		cerr << "[] : Ҫ " << length << " ֽڣ  " << cap << " ֽ" << endl;
+		return false;
+	}
+
+	// ׼дͷ(Уֵд)
+	StegoHeader header;
+	memcpy(header.signature, "STEG", 4);           // ħʶ
+	header.dataLength = static_cast<uint32_t>(length);
+	header.crc32Value = 0;
+	header.stegoMode = static_cast<uint16_t>(ctx.mode | (usesRowLayout(ctx) ? STEGO_FMT_ROW_LAYOUT : 0) |
+		checksumFlag(ctx.checksum) | (ctx.chunkSize ? STEGO_FMT_CHUNKED : 0) | formatFlags);
+	header.channelMask = ctx.channelMask;
+
+	// λ
+	StegoCarrier carrier;
+	if (!openCarrierForWrite(bmp, ctx, carrier)) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	size_t stored = ctx.chunkSize ? chunkTableSize(length, ctx.chunkSize) + length : length;
+	markEmbedded(bmp, ctx, 0, sizeof(StegoHeader) + stored);
+	if (!writePayload(carrier, header, length, blockSize, source, ctx)) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief ݷֱصͬһĸвԱ
+ *
+ * ÿȡдʱƸغֱӱ棬漴ͷţ
+ * ͬʱڵĸ߳
+ *
+ * @param[in] cover ģ
+ * @param[in] jobs ݼļ
+ * @param[in] ctx дĲ
+ * @param[out] succeeded Ƿɹ
+ * @return ȫɹtrue
+ */
+bool StegoCore::hideFanOut(const BmpImage& cover, const std::vector<FanOutJob>& jobs, const StegoContext& ctx,
+	std::vector<unsigned char>& succeeded)
+{
+	succeeded.assign(jobs.size(), 0);
+	auto hideOne = [&](size_t i) {
+		const FanOutJob& job = jobs[i];
+		BmpImage clone;
+		if (!cover.cloneCopyOnWrite(clone)) return;
+		if (!hideData(clone, job.data, job.length, ctx)) return;
+		if (!clone.save(job.output)) return;
+		succeeded[i] = 1;
+	};
+
+	shared_ptr<ThreadPool> pool = (jobs.size() > 1) ? acquirePool(resolveThreads(ctx)) : nullptr;
+	if (pool) {
+		pool->parallelFor(jobs.size(), hideOne);
+	}
+	else {
+		for (size_t i = 0; i < jobs.size(); ++i) hideOne(i);
+	}
+	return find(succeeded.begin(), succeeded.end(), 0) == succeeded.end();
+}
+
+/**
+ * @brief ݷƬصBMPͼ
+ *
+ * ͼ˳ÿͼ(۳Ƭͷ)ɷƬͷͼ
+ * calculateCapacityʵʹõּͨ㣬ģʽλλһ¡
+ * ȷ㹻̳߳ϲǶƬÿƬݲΪƬͷӦһݡ
+ *
+ * @param[in,out] covers ͼ
+ * @param[in] data ݵָֻ
+ * @param[in] length ݳ(ֽ)
+ * @param[in] ctx дĲ
+ * @param[out] usedCovers ˷Ƭͼ±
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::hideSharded(std::vector<BmpImage>& covers, const char* data, size_t length, const StegoContext& ctx,
+	std::vector<size_t>& usedCovers)
+{
+	usedCovers.clear();
+	if (length == 0 || length > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ݳȲϷ: " << length << " ֽ" << endl;
+		return false;
+	}
+
+	// 滮Ƭĳͼ
+	vector<size_t> offsets;
+	vector<size_t> sizes;
+	size_t planned = 0;
+	for (size_t i = 0; i < covers.size() && planned < length; ++i) {
+		size_t cap = calculateCapacity(covers[i], ctx);
+		if (cap <= sizeof(StegoShardHeader)) continue;
+		size_t n = min(cap - sizeof(StegoShardHeader), length - planned);
+		usedCovers.push_back(i);
+		offsets.push_back(planned);
+		sizes.push_back(n);
+		planned += n;
+	}
+	if (planned < length) {
+		cerr << "[] : Ҫ " << length << " ֽڣ ȫ " << planned << " ֽ" << endl;
+		usedCovers.clear();
+		return false;
+	}
+	if (usedCovers.size() > numeric_limits<uint16_t>::max()) {
+		cerr << "[] Ƭ: " << usedCovers.size() << endl;
+		usedCovers.clear();
+		return false;
+	}
+
+	StegoShardHeader base;
+	memcpy(base.signature, "SHRD", 4);
+	base.payloadId = static_cast<uint32_t>(random_device()()) ^
+		static_cast<uint32_t>(chrono::steady_clock::now().time_since_epoch().count());
+	base.totalLength = static_cast<uint32_t>(length);
+	base.index = 0;
+	base.count = static_cast<uint16_t>(usedCovers.size());
+
+	size_t threads = resolveThreads(ctx);
+	atomic<bool> ok(true);
+	auto embed = [&](size_t s) {
+		StegoShardHeader shard = base;
+		shard.index = static_cast<uint16_t>(s);
+		const char* piece = data + offsets[s];
+
+		// ݲֵĵoffsetֽǷƬͷΪƬ
+		vector<char> block;
+		auto source = [&](size_t offset, size_t n) -> char* {
+			if (block.size() < n) block.resize(n);
+			size_t done = 0;
+			if (offset < sizeof(shard)) {
+				done = min(sizeof(shard) - offset, n);
+				memcpy(block.data(), reinterpret_cast<const char*>(&shard) + offset, done);
+			}
+			if (n > done) memcpy(block.data() + done, piece + (offset + done - sizeof(shard)), n - done);
+			return block.data();
+		};
+		if (!hidePayload(covers[usedCovers[s]], sizeof(shard) + sizes[s], kBlockSize * threads, source, ctx,
+			STEGO_FMT_SHARD)) {
+			cerr << "[] Ƭ " << s << " д " << usedCovers[s] << " ʧ" << endl;
+			ok = false;
+		}
+	};
+
+	shared_ptr<ThreadPool> pool = (usedCovers.size() > 1) ? acquirePool(threads) : nullptr;
+	if (pool) {
+		pool->parallelFor(usedCovers.size(), embed);
+	}
+	else {
+		for (size_t s = 0; s < usedCovers.size(); ++s) embed(s);
+	}
+	return ok.load();
+}
+
+/**
+ * @brief ӶBMPͼȡƬ
+ *
+ * ͼ̳߳ϲȡ(ÿͼڲԶֶζȡͬһ̳߳)
+ * ݲԷƬͷͷΪƬͼ˳еһЧƬıʶȷƬ飬
+ * Ҫȫҳ֮͵ݳȡ
+ *
+ * @param[in] images зƬͼ
+ * @param[out] outData ݻָ(delete[])
+ * @param[out] outLength ݳ
+ * @param[in,out] ctx д
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::extractSharded(const std::vector<BmpImage>& images, char*& outData, size_t& outLength,
+	StegoContext& ctx)
+{
+	outData = nullptr;
+	outLength = 0;
+
+	struct Piece {
+		bool             valid = false;
+		StegoShardHeader shard{};
+		vector<char>     data;
+		StegoContext     ctx;
+	};
+	vector<Piece> pieces(images.size());
+	auto decode = [&](size_t i) {
+		Piece& p = pieces[i];
+		p.ctx = ctx;
+		char* buffer = nullptr;
+		size_t len = 0;
+		if (!extractData(images[i], buffer, len, p.ctx)) return;
+		unique_ptr<char[]> owner(buffer);
+		if (len < sizeof(StegoShardHeader) || memcmp(buffer, "SHRD", 4) != 0) return;
+		memcpy(&p.shard, buffer, sizeof(StegoShardHeader));
+		p.data.assign(buffer + sizeof(StegoShardHeader), buffer + len);
+		p.valid = p.shard.count > 0 && p.shard.index < p.shard.count;
+	};
+
+	shared_ptr<ThreadPool> pool = (images.size() > 1) ? acquirePool(resolveThreads(ctx)) : nullptr;
+	if (pool) {
+		pool->parallelFor(images.size(), decode);
+	}
+	else {
+		for (size_t i = 0; i < images.size(); ++i) decode(i);
+	}
+
+	// ȷƬ鲢Źλ
+	const Piece* first = nullptr;
+	for (const Piece& p : pieces) {
+		if (p.valid) { first = &p; break; }
+	}
+	if (!first) {
+		cerr << "[] δҵƬ" << endl;
+		return false;
+	}
+	const StegoShardHeader& group = first->shard;
+	vector<const Piece*> ordered(group.count, nullptr);
+	size_t others = 0;
+	for (const Piece& p : pieces) {
+		if (!p.valid) continue;
+		if (p.shard.payloadId != group.payloadId) {
+			++others;
+			continue;
+		}
+		if (p.shard.count != group.count || p.shard.totalLength != group.totalLength) {
+			cerr << "[] ͬһƬܳȲһ" << endl;
+			return false;
+		}
+		if (!ordered[p.shard.index]) ordered[p.shard.index] = &p;
+	}
+	if (others > 0) {
+		cerr << "[]  " << others << " ݵķƬ" << endl;
+	}
+
+	size_t total = 0;
+	for (size_t s = 0; s < ordered.size(); ++s) {
+		if (!ordered[s]) {
+			cerr << "[] Ƭ: ȱٵ " << s + 1 << "/" << ordered.size() << " Ƭ" << endl;
+			return false;
+		}
+		total += ordered[s]->data.size();
+	}
+	if (total != group.totalLength) {
+		cerr << "[] Ƭ֮(" << total << ")ݳ(" << group.totalLength << ")һ" << endl;
+		return false;
+	}
+
+	try {
+		outData = new char[total];
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: " << total << " ֽ" << endl;
+		return false;
+	}
+	size_t offset = 0;
+	for (const Piece* p : ordered) {
+		if (!p->data.empty()) memcpy(outData + offset, p->data.data(), p->data.size());
+		offset += p->data.size();
+	}
+	outLength = total;
+	ctx = ordered[0]->ctx;
+	return true;
+}
+
+/**
+ * @struct StegoCore::SegmentState
+ * @brief ķֶ뵱ǰֶα
+ */
+struct StegoCore::SegmentState {
+	StegoCarrier      region;          ///< λݲλ
+	StegoHeader       header{};        ///< дͷ
+	StegoSegmentSuper super{};         ///< 
+	size_t            slotSize = 0;    ///< ÿֶαλֽ
+	size_t            dataStart = 0;   ///< ֶݲе
+	int               slot = 0;        ///< ǰֶαڵĲλ
+	uint32_t          generation = 0;  ///< ǰֶαĴ
+	vector<StegoSegmentEntry> entries; ///< ǰֶαĸ
+};
+
+/**
+ * @struct StegoCore::ArchiveState
+ * @brief Ա
+ */
+struct StegoCore::ArchiveState {
+	StegoCarrier            region;    ///< λݲλ
+	StegoHeader             header{};  ///< дͷ
+	vector<StegoMemberInfo> members;   ///< ԱϢ
+};
+
+/**
+ * @brief ɹȡͷд
+ * @param[in,out] ctx д
+ * @param[in] header Уͨͷ
+ */
+static void applyHeader(StegoContext& ctx, const StegoHeader& header)
+{
+	ctx.mode = static_cast<SteganoMode>(header.stegoMode & STEGO_FMT_MODE_MASK);
+	ctx.layout = (header.stegoMode & STEGO_FMT_ROW_LAYOUT) ? STEGO_LAYOUT_ROWS : STEGO_LAYOUT_LEGACY;
+	ctx.channelMask = header.channelMask;
+	ctx.checksum = headerChecksum(header);
+}
+
+/**
+ * @brief BMPͼȡ
+ *
+ * ʵȡҪ̣
+ * 1. findPayloadҵͷЧĺѡ
+ * 2. ͷ֮ȡܲۼУֵ
+ * 3. Уֵһʱѡ
+ *
+ * Զʱѡ̳߳ϲԣȡ˳ǰĳɹѡһ£
+ * ĳѡɹڶȡĺѡһȡǰ
+ *
+ * @param[in] bmp BMPͼ(ֻ)
+ * @param[out] outData ݻָ(delete[])
+ * @param[out] outLength ʵʳ
+ * @param[in,out] ctx д(autoDetect=trueʱmodechannelMask)
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::extractData(const BmpImage& bmp, char*& outData, size_t& outLength, StegoContext& ctx)
+{
+	// ʼ
+	outData = nullptr;
+	outLength = 0;
+
+	mutex resultMutex;
+	size_t bestIndex = numeric_limits<size_t>::max();
+	StegoHeader bestHeader;
+	size_t damagedIndex = numeric_limits<size_t>::max();
+	vector<StegoByteRange> damaged;
+	auto handler = [&](size_t index, StegoCarrier& carrier, const StegoHeader& hdr, const CancelCheck& cancelled) {
+		size_t len = hdr.dataLength;
+		char* buf = nullptr;
+		if (hdr.stegoMode & STEGO_FMT_SEGMENTED) {
+			// ֶθʽǰֶαƴӸֶ
+			if (!readAllSegments(carrier, hdr, ctx, cancelled, buf, len)) return false;
+		}
+		else {
+			// ڴ
+			try {
+				buf = new char[len];
+			}
+			catch (...) {
+				cerr << "[] ڴʧ: " << len << " ֽ" << endl;
+				return false;
+			}
+
+			// ȡ֤ܲݲ(ֱӶ)ѱȡʱֹͣȡ
+			// ֿУʽڵһ𻵵ķֿ鴦ֹͣ¼˳ǰĺѡ𻵷Χ
+			auto buffer = [buf, &cancelled](size_t offset, size_t) { return cancelled() ? nullptr : buf + offset; };
+			vector<StegoByteRange> bad;
+			if (!readPayload(carrier, hdr, kBlockSize * resolveThreads(ctx), buffer, PayloadSink(), ctx, &bad)) {
+				delete[] buf;
+				if (!bad.empty()) {
+					lock_guard<mutex> lock(resultMutex);
+					if (index < damagedIndex) {
+						damaged = move(bad);
+						damagedIndex = index;
+					}
+				}
+				return false;
+			}
+		}
+
+		// ȡɹ˳ǰĽ
+		lock_guard<mutex> lock(resultMutex);
+		if (index > bestIndex) {
+			delete[] buf;
+			return true;
+		}
+		delete[] outData;
+		outData = buf;
+		outLength = len;
+		bestIndex = index;
+		bestHeader = hdr;
+		return true;
+	};
+	ctx.damaged.clear();
+	if (findPayload(bmp, ctx, handler, true, ctx.detect)) {
+		applyHeader(ctx, bestHeader);
+		return true;
+	}
+
+	// гԶʧ
+	if (!damaged.empty()) {
+		cerr << "[] ݿУʧ: ֽ [" << damaged.front().offset << ", "
+			<< damaged.front().offset + damaged.front().length << ")" << endl;
+		ctx.damaged = move(damaged);
+		return false;
+	}
+	if (!ctx.autoDetect) {
+		cerr << "[] ȡʧܣû" << endl;
+	}
+	return false;
+}
+
+/**
+ * @brief BMPͼȡݲд
+ *
+ * ҵһͷЧĺѡ󼴿ʼдٳѡԶʱѡͷȡ
+ * ʹ黺룺ÿɺں̨߳д
+ * ͬʱһ飻дǰȴһдɣ֤д˳뻺ðȫ
+ *
+ * @param[in] bmp BMPͼ(ֻ)
+ * @param[in,out] out 
+ * @param[out] outLength дݳ
+ * @param[in,out] ctx д
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::extractStream(const BmpImage& bmp, std::ostream& out, size_t& outLength, StegoContext& ctx)
+{
+	outLength = 0;
+	bool attempted = false;
+	bool ok = false;
+	ctx.damaged.clear();
+
+	auto handler = [&](size_t, StegoCarrier& carrier, const StegoHeader& hdr, const CancelCheck&) {
+		attempted = true;
+		if (hdr.stegoMode & STEGO_FMT_SEGMENTED) {
+			// ֶθʽֶζȡдڴռΪֶεĴС
+			SegmentState state;
+			ok = loadSegments(carrier, hdr, ctx, state);
+			if (!ok) cerr << "[] ֶαȡʧ" << endl;
+			size_t total = 0;
+			vector<char> segment;
+			for (size_t i = 0; ok && i < state.entries.size(); ++i) {
+				try {
+					segment.resize(state.entries[i].length);
+				}
+				catch (...) {
+					cerr << "[] ڴʧ: " << state.entries[i].length << " ֽ" << endl;
+					ok = false;
+					break;
+				}
+				if (!readSegment(state, i, segment.data(), ctx)) {
+					cerr << "[] ֶ " << i << " ȡУʧܣдЧ" << endl;
+					ok = false;
+				}
+				else if (!out.write(segment.data(), static_cast<streamsize>(segment.size()))) {
+					cerr << "[] дʧ" << endl;
+					ok = false;
+				}
+				total += segment.size();
+			}
+			if (ok) {
+				outLength = total;
+				applyHeader(ctx, hdr);
+			}
+			return true;
+		}
+
+		size_t len = hdr.dataLength;
+		size_t chunk = min(len, kStreamChunkSize);
+		vector<char> buffers[2];
+		future<bool> pending; // ڻ֮ʱȵȴδɵд
+		try {
+			buffers[0].resize(chunk);
+			buffers[1].resize(chunk);
+		}
+		catch (...) {
+			cerr << "[] ڴʧ: " << chunk << " ֽ" << endl;
+			return true;
+		}
+
+		int current = 0;
+		auto buffer = [&](size_t, size_t) { return buffers[current].data(); };
+		auto sink = [&](const char* block, size_t n) {
+			if (pending.valid() && !pending.get()) return false;
+			pending = async(launch::async | launch::deferred, [&out, block, n]() {
+				out.write(block, static_cast<streamsize>(n));
+				return static_cast<bool>(out);
+			});
+			current ^= 1;
+			return true;
+		};
+
+		bool decoded = readPayload(carrier, hdr, chunk, buffer, sink, ctx, &ctx.damaged);
+		bool written = !pending.valid() || pending.get();
+		if (!written) {
+			cerr << "[] дʧ" << endl;
+		}
+		else if (!ctx.damaged.empty()) {
+			cerr << "[] ݿУʧ: ֽ [" << ctx.damaged.front().offset << ", "
+				<< ctx.damaged.front().offset + ctx.damaged.front().length << ")дЧ" << endl;
+		}
+		else if (!decoded) {
+			cerr << "[] ݶȡУʧܣдЧ" << endl;
+		}
+		ok = decoded && written;
+		if (ok) {
+			outLength = len;
+			applyHeader(ctx, hdr);
+		}
+		return true;
+	};
+	findPayload(bmp, ctx, handler, false, ctx.detect);
+
+	if (!attempted && !ctx.autoDetect) {
+		cerr << "[] ȡʧܣû" << endl;
+	}
+	return ok;
+}
+
+/**
+ * @brief Удݲȫ𻵵ֽڷΧ
+ *
+ * findPayload˳γԺѡȡȫݵ
+ * - ֿУʽ˶ȫֿ飬Чܸúѡ
+ * - ֶθʽԱȡֶԱֶαԱЧܸúѡ
+ * - ֻУֵУʧʱ޷ôȳѡ
+ *   ȫʧʱѵһͷЧĺѡ屨Ϊ
+ *
+ * @param[in] bmp BMPͼ(ֻ)
+ * @param[out] damaged УʧܵķΧ
+ * @param[out] length ݳ
+ * @param[in,out] ctx д
+ * @return ҵͷЧݷtrue
+ */
+bool StegoCore::verifyData(const BmpImage& bmp, std::vector<StegoByteRange>& damaged, size_t& length,
+	StegoContext& ctx)
+{
+	damaged.clear();
+	length = 0;
+
+	StegoHeader found;
+	bool fallback = false;
+	StegoHeader fallbackHeader;
+	auto handler = [&](size_t, StegoCarrier& carrier, const StegoHeader& hdr, const CancelCheck&) {
+		vector<StegoByteRange> bad;
+		size_t len = hdr.dataLength;
+		vector<char> block;
+		if (hdr.stegoMode & STEGO_FMT_SEGMENTED) {
+			SegmentState state;
+			if (!loadSegments(carrier, hdr, ctx, state)) return false;
+			len = 0;
+			for (size_t i = 0; i < state.entries.size(); ++i) {
+				size_t n = state.entries[i].length;
+				try {
+					block.resize(n);
+				}
+				catch (...) {
+					cerr << "[] ڴʧ: " << n << " ֽ" << endl;
+					return false;
+				}
+				if (!readSegment(state, i, block.data(), ctx)) appendRange(bad, len, n);
+				len += n;
+			}
+		}
+		else if (hdr.stegoMode & STEGO_FMT_ARCHIVE) {
+			ArchiveState state;
+			if (!loadArchiveIndex(carrier, hdr, ctx, state)) return false;
+			for (const StegoMemberInfo& m : state.members) {
+				try {
+					block.resize(m.length);
+				}
+				catch (...) {
+					cerr << "[] ڴʧ: " << m.length << " ֽ" << endl;
+					return false;
+				}
+				if (!readMember(state, m, block.data(), ctx)) appendRange(bad, m.offset, m.length);
+			}
+		}
+		else {
+			size_t blockSize = kBlockSize * resolveThreads(ctx);
+			try {
+				block.resize(min(len, blockSize));
+			}
+			catch (...) {
+				cerr << "[] ڴʧ: " << min(len, blockSize) << " ֽ" << endl;
+				return false;
+			}
+			auto buffer = [&block](size_t, size_t) { return block.data(); };
+			if (!readPayload(carrier, hdr, blockSize, buffer, PayloadSink(), ctx, &bad, true) && bad.empty()) {
+				if (!(hdr.stegoMode & STEGO_FMT_CHUNKED) && !fallback) {
+					fallback = true;
+					fallbackHeader = hdr;
+				}
+				return false;
+			}
+		}
+		damaged = move(bad);
+		length = len;
+		found = hdr;
+		return true;
+	};
+	if (findPayload(bmp, ctx, handler, false, ctx.detect)) {
+		applyHeader(ctx, found);
+		return true;
+	}
+	if (fallback) {
+		length = fallbackHeader.dataLength;
+		damaged.push_back(StegoByteRange{ 0, length });
+		applyHeader(ctx, fallbackHeader);
+		return true;
+	}
+
+	if (!ctx.autoDetect) {
+		cerr << "[] δҵЧдݣû" << endl;
+	}
+	return false;
+}
+
+/**
+ * @brief һֶαλֽ
+ * @param[in] maxSegments ֶ
+ * @return λͷȫֽ
+ */
+static size_t segmentSlotSize(size_t maxSegments)
+{
+	return sizeof(StegoSegmentTable) + maxSegments * sizeof(StegoSegmentEntry);
+}
+
+/**
+ * @brief ֶαλݲеƫ
+ * @param[in] slotSize λֽ
+ * @param[in] slot λ(01)
+ * @return ƫ(ֽ)
+ */
+static size_t segmentSlotOffset(size_t slotSize, int slot)
+{
+	return sizeof(StegoSegmentSuper) + static_cast<size_t>(slot) * slotSize;
+}
+
+/**
+ * @brief ֶαУֵ
+ * @param[in] type У㷨
+ * @param[in] table λͷеtableCrc0
+ * @param[in] entries 
+ * @param[in] count 
+ * @return Уֵ
+ */
+static uint32_t segmentTableCrc(ChecksumType type, StegoSegmentTable table, const StegoSegmentEntry* entries,
+	size_t count)
+{
+	table.tableCrc = 0;
+	uint32_t crc = checksumUpdate(type, 0, &table, sizeof(table));
+	return checksumUpdate(type, crc, entries, count * sizeof(StegoSegmentEntry));
+}
+
+/**
+ * @brief ڷֶΪѡλ
+ *
+ * ȷзֶ֮ʹ־ʽ׷ǰĩβռ䲻ʱȡһ㹻Ŀ϶
+ * λò뵱ǰֶαеκηֶص˷ֶαлǰԭݱ
+ *
+ * @param[in] entries ǰֶα
+ * @param[in] dataStart ֶ
+ * @param[in] regionLength ݲֳ
+ * @param[in] length ݳ
+ * @param[out] offset ѡƫ
+ * @return ҵλ÷true
+ */
+static bool placeSegment(const vector<StegoSegmentEntry>& entries, size_t dataStart, size_t regionLength,
+	size_t length, size_t& offset)
+{
+	vector<pair<size_t, size_t>> used;
+	size_t tail = dataStart;
+	for (const StegoSegmentEntry& e : entries) {
+		used.emplace_back(e.offset, static_cast<size_t>(e.offset) + e.length);
+		tail = max(tail, used.back().second);
+	}
+	if (tail <= regionLength && length <= regionLength - tail) {
+		offset = tail;
+		return true;
+	}
+
+	sort(used.begin(), used.end());
+	size_t cursor = dataStart;
+	for (const auto& extent : used) {
+		if (extent.first >= cursor && extent.first - cursor >= length) {
+			offset = cursor;
+			return true;
+		}
+		cursor = max(cursor, extent.second);
+	}
+	return false;
+}
+
+/**
+ * @brief ͼвҷֶݲȡǰֶα
+ *
+ * findPayload˳ܵһֶθʽҷֶαЧĺѡҵʱͷctx
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in,out] ctx д
+ * @param[out] state ֶ״̬
+ * @return ҵtrueϢ
+ */
+bool StegoCore::findSegmented(const BmpImage& bmp, StegoContext& ctx, SegmentState& state)
+{
+	auto handler = [&](size_t, StegoCarrier& carrier, const StegoHeader& hdr, const CancelCheck&) {
+		return (hdr.stegoMode & STEGO_FMT_SEGMENTED) && loadSegments(carrier, hdr, ctx, state);
+	};
+	if (!findPayload(bmp, ctx, handler, false, ctx.detect)) return false;
+	applyHeader(ctx, state.header);
+	return true;
+}
+
+/**
+ * @brief ȡֶαλѡǰֶα
+ *
+ * ͷݳȼУֵһ£λʶУֵȷҸֶλڷֶڣ
+ * λЧʱȡϴߡ
+ *
+ * @param[in] region λݲλ
+ * @param[in] header ֶθʽͷ
+ * @param[in] ctx д(ʹе)
+ * @param[out] state ֶ״̬
+ * @return һλЧʱtrue
+ */
+bool StegoCore::loadSegments(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+	SegmentState& state) const
+{
+	ChecksumType type = headerChecksum(header);
+	state = SegmentState();
+	state.region = region;
+	state.header = header;
+
+	StegoSegmentSuper& super = state.super;
+	StegoCarrier cursor = region;
+	if (!cursor.read(reinterpret_cast<char*>(&super), sizeof(super))) return false;
+	xorEncryptBuffer(reinterpret_cast<char*>(&super), sizeof(super), ctx.password, 0);
+	if (memcmp(super.signature, "SEGS", 4) != 0 || super.version != 1 || super.maxSegments == 0 ||
+		super.regionLength != header.dataLength ||
+		checksumUpdate(type, 0, &super, sizeof(super)) != header.crc32Value) {
+		return false;
+	}
+	state.slotSize = segmentSlotSize(super.maxSegments);
+	state.dataStart = segmentSlotOffset(state.slotSize, 2);
+	if (state.dataStart > super.regionLength) return false;
+
+	bool found = false;
+	for (int slot = 0; slot < 2; ++slot) {
+		size_t offset = segmentSlotOffset(state.slotSize, slot);
+		StegoSegmentTable table;
+		cursor = region;
+		if (!cursor.skip(offset) || !cursor.read(reinterpret_cast<char*>(&table), sizeof(table))) continue;
+		xorEncryptBuffer(reinterpret_cast<char*>(&table), sizeof(table), ctx.password, offset);
+		if (memcmp(table.signature, "SEGT", 4) != 0 || table.count > super.maxSegments) continue;
+		if (found && table.generation <= state.generation) continue;
+
+		vector<StegoSegmentEntry> entries(table.count);
+		size_t bytes = entries.size() * sizeof(StegoSegmentEntry);
+		if (!cursor.read(reinterpret_cast<char*>(entries.data()), bytes)) continue;
+		xorEncryptBuffer(reinterpret_cast<char*>(entries.data()), bytes, ctx.password, offset + sizeof(table));
+		if (segmentTableCrc(type, table, entries.data(), entries.size()) != table.tableCrc) continue;
+		bool inRange = all_of(entries.begin(), entries.end(), [&](const StegoSegmentEntry& e) {
+			return e.offset >= state.dataStart && e.offset <= super.regionLength &&
+				e.length <= super.regionLength - e.offset;
+		});
+		if (!inRange) continue;
+
+		state.slot = slot;
+		state.generation = table.generation;
+		state.entries = move(entries);
+		found = true;
+	}
+	return found;
+}
+
+/**
+ * @brief ȡܲУһֶΣֻȡ÷ֶڵλ
+ * @param[in] state ֶ״̬
+ * @param[in] index ֶţСڷֶ
+ * @param[out] dst Ŀ껺Ϊֶγ
+ * @param[in] ctx д(ʹе)
+ * @return ȡɹУֵһ·true
+ */
+bool StegoCore::readSegment(const SegmentState& state, size_t index, char* dst, const StegoContext& ctx) const
+{
+	const StegoSegmentEntry& entry = state.entries[index];
+	StegoCarrier cursor = state.region;
+	if (!cursor.skip(entry.offset) || !cursor.read(dst, entry.length)) return false;
+	xorEncryptBuffer(dst, entry.length, ctx.password, entry.offset);
+	return checksumUpdate(headerChecksum(state.header), 0, dst, entry.length) == entry.crc;
+}
+
+/**
+ * @brief ǰֶαζȡȫֶβƴ
+ * @param[in] region λݲλ
+ * @param[in] header ֶθʽͷ
+ * @param[in] ctx д
+ * @param[in] cancelled ȡѯÿֶζȡǰ
+ * @param[out] outData ƴӺ(delete[])
+ * @param[out] outLength ݳ
+ * @return ֶαЧҸֶУֵһ·true
+ */
+bool StegoCore::readAllSegments(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+	const CancelCheck& cancelled, char*& outData, size_t& outLength) const
+{
+	SegmentState state;
+	if (!loadSegments(region, header, ctx, state)) return false;
+
+	size_t total = 0;
+	for (const StegoSegmentEntry& e : state.entries) total += e.length;
+	char* buf = nullptr;
+	try {
+		buf = new char[total];
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: " << total << " ֽ" << endl;
+		return false;
+	}
+
+	size_t pos = 0;
+	for (size_t i = 0; i < state.entries.size(); ++i) {
+		if (cancelled() || !readSegment(state, i, buf + pos, ctx)) {
+			delete[] buf;
+			return false;
+		}
+		pos += state.entries[i].length;
+	}
+	outData = buf;
+	outLength = total;
+	return true;
+}
+
+/**
+ * @brief ܲдݲеһΣǼǱ޸ĵطΧ
+ * @param[in,out] bmp BMPͼ
+ * @param[in] region λݲĿдλ
+ * @param[in] offset ݲеƫ
+ * @param[in] plain 
+ * @param[in] n ֽ
+ * @param[in] ctx д
+ * @return ɹtrue
+ */
+bool StegoCore::writeRegion(BmpImage& bmp, const StegoCarrier& region, size_t offset, const char* plain, size_t n,
+	const StegoContext& ctx) const
+{
+	vector<char> block(plain, plain + n);
+	xorEncryptBuffer(block.data(), n, ctx.password, offset);
+	StegoCarrier cursor = region;
+	if (!cursor.skip(offset)) return false;
+	markEmbedded(bmp, ctx, sizeof(StegoHeader) + offset, n);
+	return cursor.write(block.data(), n);
+}
+
+/**
+ * @brief µķֶαдǵǰλʹΪǰֶα
+ * @param[in,out] bmp BMPͼ
+ * @param[in] region λݲĿдλ
+ * @param[in,out] state ֶ״̬ɹʱΪ·ֶα
+ * @param[in] entries ·ֶαĸ
+ * @param[in] ctx д
+ * @return ɹtrue
+ */
+bool StegoCore::commitSegments(BmpImage& bmp, const StegoCarrier& region, SegmentState& state,
+	const std::vector<StegoSegmentEntry>& entries, const StegoContext& ctx) const
+{
+	StegoSegmentTable table = {};
+	memcpy(table.signature, "SEGT", 4);
+	table.generation = state.generation + 1;
+	table.count = static_cast<uint16_t>(entries.size());
+	table.tableCrc = segmentTableCrc(headerChecksum(state.header), table, entries.data(), entries.size());
+
+	// ֻдλͷʵʹõı
+	size_t bytes = entries.size() * sizeof(StegoSegmentEntry);
+	vector<char> slot(sizeof(table) + bytes);
+	memcpy(slot.data(), &table, sizeof(table));
+	if (bytes > 0) memcpy(slot.data() + sizeof(table), entries.data(), bytes);
+
+	int target = state.slot ^ 1;
+	if (!writeRegion(bmp, region, segmentSlotOffset(state.slotSize, target), slot.data(), slot.size(), ctx)) {
+		return false;
+	}
+	state.slot = target;
+	state.generation = table.generation;
+	state.entries = entries;
+	return true;
+}
+
+/**
+ * @brief ҷֶݲ򿪿дݲλ
+ *
+ * ȡÿд(ֻӳͼڴתΪڴ渱)ٲҷֶݣ
+ * ʹֶαдʹͬһء
+ *
+ * @param[in,out] bmp BMPͼ
+ * @param[in,out] ctx дģҵʱͷ
+ * @param[out] state ֶ״̬
+ * @param[out] region λݲĿдλ
+ * @return ɹtrue
+ */
+bool StegoCore::openSegmentsForWrite(BmpImage& bmp, StegoContext& ctx, SegmentState& state, StegoCarrier& region)
+{
+	if (!bmp.getWritablePixels() || !findSegmented(bmp, ctx, state)) {
+		cerr << "[] δҵֶд" << endl;
+		return false;
+	}
+	if (!openCarrierForWrite(bmp, ctx, region) || !region.skip(sizeof(StegoHeader))) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief BMPͼ½յķֶ
+ *
+ * ͷݳΪԤ򳤶ȣУֵȡУֵһλдշֶα
+ * ڶλдȫͷʹЧвľݱΪֶα
+ * ֶд롣
+ *
+ * @param[in,out] bmp ѼصBMPͼ(޸)
+ * @param[in] ctx дĲ
+ * @param[in] maxSegments ֶ
+ * @param[in] regionLength Ԥݲֳȣ0ʾʹȫ
+ * @return ɹtrue
+ */
+bool StegoCore::createSegmented(BmpImage& bmp, const StegoContext& ctx, size_t maxSegments, size_t regionLength)
+{
+	if (maxSegments == 0 || maxSegments > numeric_limits<uint16_t>::max()) {
+		cerr << "[] ֶ޲Ϸ: " << maxSegments << endl;
+		return false;
+	}
+	// ֶɷֶαУ飬ʹ÷ֿУ飻Ԥ򲻳ʵʿɵֽ
+	// placeSegmentѡдµƫ
+	StegoContext whole = ctx;
+	whole.chunkSize = 0;
+	size_t cap = min<size_t>(calculateCapacity(bmp, whole), numeric_limits<uint32_t>::max());
+	size_t dataStart = segmentSlotOffset(segmentSlotSize(maxSegments), 2);
+	if (regionLength == 0) regionLength = cap;
+	if (regionLength > cap || regionLength <= dataStart) {
+		cerr << "[] : Ҫ " << max(regionLength, dataStart + 1) << " ֽڣ  " << cap << " ֽ" << endl;
+		return false;
+	}
+
+	StegoSegmentSuper super = {};
+	memcpy(super.signature, "SEGS", 4);
+	super.version = 1;
+	super.maxSegments = static_cast<uint16_t>(maxSegments);
+	super.regionLength = static_cast<uint32_t>(regionLength);
+
+	StegoHeader header;
+	memcpy(header.signature, "STEG", 4);
+	header.dataLength = static_cast<uint32_t>(regionLength);
+	header.crc32Value = checksumUpdate(ctx.checksum, 0, &super, sizeof(super));
+	header.stegoMode = static_cast<uint16_t>(ctx.mode | (usesRowLayout(ctx) ? STEGO_FMT_ROW_LAYOUT : 0) |
+		checksumFlag(ctx.checksum) | STEGO_FMT_SEGMENTED);
+	header.channelMask = ctx.channelMask;
+
+	StegoSegmentTable empty = {};
+	memcpy(empty.signature, "SEGT", 4);
+	empty.generation = 1;
+	empty.tableCrc = segmentTableCrc(ctx.checksum, empty, nullptr, 0);
+	StegoSegmentTable invalid = {};
+
+	StegoCarrier carrier;
+	bool ok = openCarrierForWrite(bmp, ctx, carrier);
+	if (ok) {
+		markEmbedded(bmp, ctx, 0, sizeof(header));
+		ok = carrier.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	size_t slotSize = segmentSlotSize(maxSegments);
+	ok = ok && writeRegion(bmp, carrier, 0, reinterpret_cast<const char*>(&super), sizeof(super), ctx) &&
+		writeRegion(bmp, carrier, segmentSlotOffset(slotSize, 0), reinterpret_cast<const char*>(&empty),
+			sizeof(empty), ctx) &&
+		writeRegion(bmp, carrier, segmentSlotOffset(slotSize, 1), reinterpret_cast<const char*>(&invalid),
+			sizeof(invalid), ctx);
+	if (!ok) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief ڷֶĩβ׷һֶ
+ *
+ * дٽ±ķֶαдһλ
+ * дֶα֮ǰжʱǰֶα䣬ݲɼ
+ *
+ * @param[in,out] bmp зֶݵBMPͼ
+ * @param[in] data ֶ
+ * @param[in] length ֶγ
+ * @param[in,out] ctx д
+ * @param[out] index ·ֶε
+ * @return ɹtrue
+ */
+bool StegoCore::appendSegment(BmpImage& bmp, const char* data, size_t length, StegoContext& ctx, size_t& index)
+{
+	if (length == 0 || length > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ݳȲϷ: " << length << " ֽ" << endl;
+		return false;
+	}
+	SegmentState state;
+	StegoCarrier region;
+	if (!openSegmentsForWrite(bmp, ctx, state, region)) return false;
+	if (state.entries.size() >= state.super.maxSegments) {
+		cerr << "[] ֶα: " << state.super.maxSegments << " " << endl;
+		return false;
+	}
+
+	size_t offset = 0;
+	if (!placeSegment(state.entries, state.dataStart, state.super.regionLength, length, offset)) {
+		cerr << "[] пռ䲻: Ҫ " << length << " ֽ" << endl;
+		return false;
+	}
+	StegoSegmentEntry entry;
+	entry.offset = static_cast<uint32_t>(offset);
+	entry.length = static_cast<uint32_t>(length);
+	entry.crc = checksumUpdate(headerChecksum(state.header), 0, data, length);
+	vector<StegoSegmentEntry> entries = state.entries;
+	entries.push_back(entry);
+
+	if (!writeRegion(bmp, region, offset, data, length, ctx) || !commitSegments(bmp, region, state, entries, ctx)) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	index = entries.size() - 1;
+	return true;
+}
+
+/**
+ * @brief 滻һֶε
+ *
+ * ׷ͬдлֶαԭֶռռ֮ͷš
+ * ݲ뵱ǰֶαеκηֶصджʱǰֶαԭֶα
+ * ʱʧܣԭλøǡ
+ *
+ * @param[in,out] bmp зֶݵBMPͼ
+ * @param[in] index ֶ
+ * @param[in] data µķֶ
+ * @param[in] length µķֶγ
+ * @param[in,out] ctx д
+ * @return ɹtrue
+ */
+bool StegoCore::replaceSegment(BmpImage& bmp, size_t index, const char* data, size_t length, StegoContext& ctx)
+{
+	if (length == 0 || length > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ݳȲϷ: " << length << " ֽ" << endl;
+		return false;
+	}
+	SegmentState state;
+	StegoCarrier region;
+	if (!openSegmentsForWrite(bmp, ctx, state, region)) return false;
+	if (index >= state.entries.size()) {
+		cerr << "[] ֶųΧ: " << index << " ( " << state.entries.size() << " ֶ)" << endl;
+		return false;
+	}
+
+	vector<StegoSegmentEntry> entries = state.entries;
+	StegoSegmentEntry& entry = entries[index];
+	size_t offset = 0;
+	if (!placeSegment(state.entries, state.dataStart, state.super.regionLength, length, offset)) {
+		cerr << "[] пռ䲻: Ҫ " << length << " ֽ" << endl;
+		return false;
+	}
+	entry.offset = static_cast<uint32_t>(offset);
+	entry.length = static_cast<uint32_t>(length);
+	entry.crc = checksumUpdate(headerChecksum(state.header), 0, data, length);
+
+	if (!writeRegion(bmp, region, offset, data, length, ctx) || !commitSegments(bmp, region, state, entries, ctx)) {
+		cerr << "[] ддʧ" << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief ȡǰֶα
+ * @param[in] bmp BMPͼ
+ * @param[out] segments ֶελáУֵ
+ * @param[in,out] ctx д
+ * @return ҵֶݷtrue
+ */
+bool StegoCore::listSegments(const BmpImage& bmp, std::vector<StegoSegmentEntry>& segments, StegoContext& ctx)
+{
+	segments.clear();
+	SegmentState state;
+	if (!findSegmented(bmp, ctx, state)) return false;
+	segments = move(state.entries);
+	return true;
+}
+
+/**
+ * @brief ȡֶ
+ * @param[in] bmp BMPͼ
+ * @param[in] index ֶ
+ * @param[out] outData ݻָ(delete[])
+ * @param[out] outLength ݳ
+ * @param[in,out] ctx д
+ * @return ɹtrue
+ */
+bool StegoCore::extractSegment(const BmpImage& bmp, size_t index, char*& outData, size_t& outLength,
+	StegoContext& ctx)
+{
+	outData = nullptr;
+	outLength = 0;
+	SegmentState state;
+	if (!findSegmented(bmp, ctx, state)) {
+		cerr << "[] δҵֶд" << endl;
+		return false;
+	}
+	if (index >= state.entries.size()) {
+		cerr << "[] ֶųΧ: " << index << " ( " << state.entries.size() << " ֶ)" << endl;
+		return false;
+	}
+
+	size_t len = state.entries[index].length;
+	char* buf = nullptr;
+	try {
+		buf = new char[len];
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: " << len << " ֽ" << endl;
+		return false;
+	}
+	if (!readSegment(state, index, buf, ctx)) {
+		cerr << "[] ֶ " << index << " ȡУʧ" << endl;
+		delete[] buf;
+		return false;
+	}
+	outData = buf;
+	outLength = len;
+	return true;
+}
+
+/**
+ * @brief ԱΪصBMPͼ
+ *
+ * ڴйͷԱ(ԱУֵڴ˼)
+ * ٰԱΪһݽhidePayloadܡУ鲢Ƕ룬ƴ
+ *
+ * @param[in,out] bmp ѼصBMPͼ(޸)
+ * @param[in] members Ա
+ * @param[in] ctx дĲ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::hideArchive(BmpImage& bmp, const std::vector<ArchiveMember>& members, const StegoContext& ctx)
+{
+	if (members.empty() || members.size() > numeric_limits<uint16_t>::max()) {
+		cerr << "[] ԱϷ: " << members.size() << endl;
+		return false;
+	}
+
+	// Ʋݵܳ
+	size_t indexLength = 0;
+	size_t total = sizeof(StegoArchiveIndex);
+	vector<string> names;
+	for (const ArchiveMember& m : members) {
+		if (m.name.empty() || m.name.size() > numeric_limits<uint16_t>::max()) {
+			cerr << "[] ԱƲϷ: " << m.name << endl;
+			return false;
+		}
+		indexLength += sizeof(StegoArchiveEntry) + m.name.size();
+		total += sizeof(StegoArchiveEntry) + m.name.size() + m.length;
+		names.push_back(m.name);
+	}
+	sort(names.begin(), names.end());
+	auto dup = adjacent_find(names.begin(), names.end());
+	if (dup != names.end()) {
+		cerr << "[] Աظ: " << *dup << endl;
+		return false;
+	}
+	if (total > numeric_limits<uint32_t>::max()) {
+		cerr << "[] ݳȲϷ: " << total << " ֽ" << endl;
+		return false;
+	}
+
+	// Աݰ˳֮
+	vector<char> index(sizeof(StegoArchiveIndex) + indexLength);
+	size_t pos = sizeof(StegoArchiveIndex);
+	size_t offset = index.size();
+	for (const ArchiveMember& m : members) {
+		StegoArchiveEntry entry = {};
+		entry.offset = static_cast<uint32_t>(offset);
+		entry.length = static_cast<uint32_t>(m.length);
+		entry.crc = checksumUpdate(ctx.checksum, 0, m.data, m.length);
+		entry.nameLength = static_cast<uint16_t>(m.name.size());
+		memcpy(index.data() + pos, &entry, sizeof(entry));
+		memcpy(index.data() + pos + sizeof(entry), m.name.data(), m.name.size());
+		pos += sizeof(entry) + m.name.size();
+		offset += m.length;
+	}
+	StegoArchiveIndex head = {};
+	memcpy(head.signature, "ARCH", 4);
+	head.count = static_cast<uint16_t>(members.size());
+	head.indexLength = static_cast<uint32_t>(indexLength);
+	memcpy(index.data(), &head, sizeof(head));
+	head.indexCrc = checksumUpdate(ctx.checksum, 0, index.data(), index.size());
+	memcpy(index.data(), &head, sizeof(head));
+
+	// ԴΪԱ
+	vector<pair<const char*, size_t>> pieces;
+	pieces.emplace_back(index.data(), index.size());
+	for (const ArchiveMember& m : members) pieces.emplace_back(m.data, m.length);
+	vector<char> block;
+	auto source = [&](size_t first, size_t n) -> char* {
+		if (block.size() < n) block.resize(n);
+		size_t filled = 0;
+		size_t base = 0;
+		for (const auto& piece : pieces) {
+			size_t end = base + piece.second;
+			if (filled < n && first + filled < end) {
+				size_t from = first + filled - base;
+				size_t take = min(piece.second - from, n - filled);
+				memcpy(block.data() + filled, piece.first + from, take);
+				filled += take;
+			}
+			base = end;
+		}
+		return block.data();
+	};
+	// ԱݲеƫֱӶλҸУֵʹ÷ֿУ
+	StegoContext whole = ctx;
+	whole.chunkSize = 0;
+	return hidePayload(bmp, total, kBlockSize * resolveThreads(ctx), source, whole, STEGO_FMT_ARCHIVE);
+}
+
+/**
+ * @brief ͼвȡԱ
+ *
+ * findPayload˳ܵһʽЧĺѡҵʱͷctx
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in,out] ctx д
+ * @param[out] state Ա
+ * @return ҵtrueϢ
+ */
+bool StegoCore::findArchive(const BmpImage& bmp, StegoContext& ctx, ArchiveState& state)
+{
+	auto handler = [&](size_t, StegoCarrier& carrier, const StegoHeader& hdr, const CancelCheck&) {
+		return (hdr.stegoMode & STEGO_FMT_ARCHIVE) && loadArchiveIndex(carrier, hdr, ctx, state);
+	};
+	if (!findPayload(bmp, ctx, handler, false, ctx.detect)) return false;
+	applyHeader(ctx, state.header);
+	return true;
+}
+
+/**
+ * @brief ȡܲУԱ
+ *
+ * ֻȡͷԱڵλԱλ֮ݲ֮ڡ
+ *
+ * @param[in] region λݲλ
+ * @param[in] header ʽͷ
+ * @param[in] ctx д(ʹе)
+ * @param[out] state Ա
+ * @return Чtrue
+ */
+bool StegoCore::loadArchiveIndex(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+	ArchiveState& state) const
+{
+	ChecksumType type = headerChecksum(header);
+	StegoArchiveIndex head;
+	if (header.dataLength < sizeof(head)) return false;
+	StegoCarrier cursor = region;
+	if (!cursor.read(reinterpret_cast<char*>(&head), sizeof(head))) return false;
+	xorEncryptBuffer(reinterpret_cast<char*>(&head), sizeof(head), ctx.password, 0);
+	if (memcmp(head.signature, "ARCH", 4) != 0 || head.count == 0 ||
+		head.indexLength > header.dataLength - sizeof(head)) {
+		return false;
+	}
+
+	vector<char> index(head.indexLength);
+	if (!cursor.read(index.data(), index.size())) return false;
+	xorEncryptBuffer(index.data(), index.size(), ctx.password, sizeof(head));
+	uint32_t expected = head.indexCrc;
+	head.indexCrc = 0;
+	uint32_t crc = checksumUpdate(type, 0, &head, sizeof(head));
+	if (checksumUpdate(type, crc, index.data(), index.size()) != expected) return false;
+
+	// ƽÿ֮
+	size_t dataStart = sizeof(head) + index.size();
+	vector<StegoMemberInfo> members;
+	size_t pos = 0;
+	for (size_t i = 0; i < head.count; ++i) {
+		StegoArchiveEntry entry;
+		if (index.size() - pos < sizeof(entry)) return false;
+		memcpy(&entry, index.data() + pos, sizeof(entry));
+		pos += sizeof(entry);
+		if (index.size() - pos < entry.nameLength) return false;
+		if (entry.offset < dataStart || entry.offset > header.dataLength ||
+			entry.length > header.dataLength - entry.offset) {
+			return false;
+		}
+
+		StegoMemberInfo info;
+		info.name.assign(index.data() + pos, entry.nameLength);
+		info.offset = entry.offset;
+		info.length = entry.length;
+		info.crc = entry.crc;
+		members.push_back(move(info));
+		pos += entry.nameLength;
+	}
+	if (pos != index.size()) return false;
+
+	state.region = region;
+	state.header = header;
+	state.members = move(members);
+	return true;
+}
+
+/**
+ * @brief ȡܲУһԱֻȡóԱڵλ
+ * @param[in] state Ա
+ * @param[in] member ԱϢ
+ * @param[out] dst Ŀ껺ΪԱ
+ * @param[in] ctx д(ʹе)
+ * @return ȡɹУֵһ·true
+ */
+bool StegoCore::readMember(const ArchiveState& state, const StegoMemberInfo& member, char* dst,
+	const StegoContext& ctx) const
+{
+	StegoCarrier cursor = state.region;
+	if (!cursor.skip(member.offset) || !cursor.read(dst, member.length)) return false;
+	xorEncryptBuffer(dst, member.length, ctx.password, member.offset);
+	return checksumUpdate(headerChecksum(state.header), 0, dst, member.length) == member.crc;
+}
+
+/**
+ * @brief ȡĳԱ
+ * @param[in] bmp BMPͼ
+ * @param[out] members ԱϢ
+ * @param[in,out] ctx д
+ * @return ҵtrue
+ */
+bool StegoCore::listMembers(const BmpImage& bmp, std::vector<StegoMemberInfo>& members, StegoContext& ctx)
+{
+	members.clear();
+	ArchiveState state;
+	if (!findArchive(bmp, ctx, state)) {
+		cerr << "[] δҵԱ" << endl;
+		return false;
+	}
+	members = move(state.members);
+	return true;
+}
+
+/**
+ * @brief ȡеĵԱ
+ *
+ * еƫֱӶλóԱλãȡܲеУֵ֤
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in] name Ա
+ * @param[out] outData ݻָ(delete[])
+ * @param[out] outLength ݳ
+ * @param[in,out] ctx д
+ * @return ɹtrue
+ */
+bool StegoCore::extractMember(const BmpImage& bmp, const std::string& name, char*& outData, size_t& outLength,
+	StegoContext& ctx)
+{
+	outData = nullptr;
+	outLength = 0;
+	ArchiveState state;
+	if (!findArchive(bmp, ctx, state)) {
+		cerr << "[] δҵԱ" << endl;
+		return false;
+	}
+	auto it = find_if(state.members.begin(), state.members.end(),
+		[&](const StegoMemberInfo& m) { return m.name == name; });
+	if (it == state.members.end()) {
+		cerr << "[] ûгԱ: " << name << endl;
+		return false;
+	}
+
+	char* buf = nullptr;
+	try {
+		buf = new char[it->length];
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: " << it->length << " ֽ" << endl;
+		return false;
+	}
+	if (!readMember(state, *it, buf, ctx)) {
+		cerr << "[] Ա " << name << " ȡУʧ" << endl;
+		delete[] buf;
+		return false;
+	}
+	outData = buf;
+	outLength = it->length;
+	return true;
+}
+
+/**
+ * @brief ֻȡļͷݿͷжBMPļǷд
+ *
+ * ȡͷֲдͷݿͷ߶㿪ʼ
+ * ϳһζ룻λƽƵ˳/ǿģʽѡͷ
+ * findPayloadͬ˳ȡһЧͷָģʽʱֱӷfalse
+ *
+ * @param[in] filename BMPļ·
+ * @param[out] header ҵʱΪͷ
+ * @param[in,out] ctx д(ҵʱmodechannelMasklayoutchecksumdetect¼ѡͳ)
+ * @return ҵЧͷtrue
+ */
+bool StegoCore::probeFile(const std::string& filename, StegoHeader& header, StegoContext& ctx)
+{
+	auto startTime = chrono::steady_clock::now();
+	StegoDetectReport report;
+
+	// չ˳/ǿģʽĺѡ˳findPayloadһ
+	struct Candidate {
+		SteganoMode mode;
+		uint16_t    mask;
+		StegoLayout layout;
+	};
+	vector<SteganoMode> modes;
+	vector<uint16_t>    masks;
+	if (ctx.autoDetect) {
+		modes = { LSB_SEQUENTIAL, LSB_ENHANCED };
+		masks = { 0x01,0x02,0x04,0x03,0x05,0x06,0x07 };
+	}
+	else if (ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED) {
+		modes = { ctx.mode };
+		masks = { ctx.channelMask };
+	}
+	vector<Candidate> candidates;
+	for (auto m : modes) {
+		for (auto mask : masks) {
+			candidates.push_back(Candidate{ m, mask, STEGO_LAYOUT_LEGACY });
+			candidates.push_back(Candidate{ m, mask, STEGO_LAYOUT_ROWS });
+		}
+	}
+	report.candidates = candidates.size();
+
+	PositionalFile file;
+	BmpHeaders headers;
+	LsbPlanes planes[2];
+	if (!candidates.empty() && file.open(filename) && BmpImage::readHeaders(file, filename, headers)) {
+		int channels[2] = { 0, 0 };
+		vector<BmpByteRun> runs[2];
+		size_t span = 0;
+		for (int l = 0; l < 2; ++l) {
+			StegoLayout layout = l ? STEGO_LAYOUT_ROWS : STEGO_LAYOUT_LEGACY;
+			if (layoutRuns(headers.infoHeader, headers.pixelSize, layout, channels[l], runs[l])) {
+				span = max(span, headerSpan(channels[l], runs[l]));
+			}
+		}
+		vector<unsigned char> prefix(span);
+		if (span > 0 && file.readAt(headers.pixelOffset, prefix.data(), span)) {
+			for (int l = 0; l < 2; ++l) {
+				if (!runs[l].empty()) collectHeaderPlanes(prefix.data(), span, channels[l], runs[l], planes[l]);
+			}
+		}
+	}
+
+	bool found = false;
+	for (size_t i = 0; i < candidates.size() && !found; ++i) {
+		const Candidate& c = candidates[i];
+		StegoHeader hdr;
+		size_t bits = sizeof(hdr) * 8;
+		if (lsbDecodePlanes(planes[(c.layout == STEGO_LAYOUT_ROWS) ? 1 : 0], c.mask, (c.mode == LSB_ENHANCED) ? 2 : 1,
+			reinterpret_cast<unsigned char*>(&hdr), bits) != bits) continue;
+		++report.probed;
+		if (headerAcceptable(headers.infoHeader, headers.pixelSize, c.mode, c.mask, c.layout, ctx, hdr)) {
+			header = hdr;
+			applyHeader(ctx, hdr);
+			report.winner = static_cast<int>(i);
+			found = true;
+		}
+	}
+
+	report.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+	ctx.detect = report;
+	return found;
+}
+
+/**
+ * @brief ԭӱ͵candidate
+ * @param[in,out] value ԭӱ
+ * @param[in] candidate ѡֵ
+ */
+static void lowerTo(atomic<size_t>& value, size_t candidate)
+{
+	size_t current = value.load();
+	while (candidate < current && !value.compare_exchange_weak(current, candidate)) {}
+}
+
+/**
+ * @brief γԸѡģʽͨ벼֣Чдͷ
+ *
+ * Զʱģʽͨϣ˳/ǿģʽȳԭвٳв֣
+ * ctxָģʽͨdetectThresholdʱͳ
+ * ˳ΪǶ˳
+ *
+ * Զ߳1ʱѡ̳߳ϲȡͷŴѳɹѡĲٳԣ
+ * - concurrentΪtruehandlerͷһִУcancelled()ڸǰĺѡܺ󷵻true
+ * - concurrentΪfalse׶ֻȡͷ֮˳εhandler
+ *   ĺѡǰĺѡܾʱٲͷ
+ * ַʽܵĺѡΪ˳еһhandlerܵĺѡһ¡
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in] ctx д
+ * @param[in] handler ѡ
+ * @param[in] concurrent handlerǷɶԲͬѡ
+ * @param[out] report ͳ
+ * @return кѡhandlerʱtrue
+ */
+bool StegoCore::findPayload(const BmpImage& bmp, const StegoContext& ctx, const CandidateHandler& handler,
+	bool concurrent, StegoDetectReport& report)
+{
+	auto startTime = chrono::steady_clock::now();
+	report = StegoDetectReport();
+
+	// ȷҪԵģʽͨ
+	vector<SteganoMode> modes;
+	vector<uint16_t>    masks;
+
+	if (ctx.autoDetect) {
+		// Զģʽпܵģʽͨ
+		modes = { LSB_SEQUENTIAL, LSB_ENHANCED, LSB_RANDOM, LSB_RANDOM_LAZY };
+		masks = { 0x01,0x02,0x04,0x03,0x05,0x06,0x07 }; // пܵͨ
+	}
+	else {
+		// ָģʽûָģʽͨ
+		modes = { ctx.mode };
+		masks = { ctx.channelMask };
+	}
+
+	// չģʽͨ벼(˳/ǿģʽȳԭв)
+	struct Candidate {
+		SteganoMode mode;
+		uint16_t    mask;
+		StegoLayout layout;
+		double      score;  ///< ͳõǶ
+	};
+	vector<Candidate> candidates;
+	for (auto m : modes) {
+		bool sequential = (m == LSB_SEQUENTIAL || m == LSB_ENHANCED);
+		for (auto mask : masks) {
+			candidates.push_back(Candidate{ m, mask, STEGO_LAYOUT_LEGACY, 1.0 });
+			if (sequential) candidates.push_back(Candidate{ m, mask, STEGO_LAYOUT_ROWS, 1.0 });
+		}
+	}
+	size_t count = candidates.size();
+	report.candidates = count;
+
+	// ͳ˳/ǿģʽѡǶȡͨеСֵʴӸߵģʽ֮ǰ
+	// ֻ·λƽɨһμжȫ˳/ǿѡͷѡʡ¶ȡ
+	// ᶪͳĶݡģʽǶɢͼУͷûпɿͳ
+	if (ctx.autoDetect && ctx.detectThreshold > 0.0) {
+		double scores[2][4];
+		leadingEmbedScores(bmp, STEGO_LAYOUT_LEGACY, scores[0]);
+		leadingEmbedScores(bmp, STEGO_LAYOUT_ROWS, scores[1]);
+		size_t sequentialEnd = 0;
+		for (Candidate& c : candidates) {
+			if (c.mode != LSB_SEQUENTIAL && c.mode != LSB_ENHANCED) break;
+			const double* layoutScores = scores[(c.layout == STEGO_LAYOUT_ROWS) ? 1 : 0];
+			for (int ch = 0; ch < 4; ++ch) {
+				if ((c.mask >> ch) & 0x01) c.score = min(c.score, layoutScores[ch]);
+			}
+			++sequentialEnd;
+		}
+		stable_sort(candidates.begin(), candidates.begin() + sequentialEnd,
+			[](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+	}
+
+	const size_t none = numeric_limits<size_t>::max();
+	atomic<size_t> winner(none);
+	atomic<size_t> probed(0);
+	atomic<size_t> cancelled(0);
+	vector<char> state(count, 0); // 0: δȡ1: Ч򱻾ܾ2: ͷЧ
+	vector<StegoCarrier> carriers(count);
+	vector<StegoHeader> headers(count);
+
+	// Զʱÿֲֻɨһ忪ͷλƽƵ˳/ǿģʽѡͷ
+	// Чĺѡٴ壻Чĺѡ԰淽ʽȡʹλͷ֮
+	if (ctx.autoDetect) {
+		LsbPlanes planes[2];
+		bool collected[2] = { false, false };
+		for (size_t i = 0; i < count; ++i) {
+			const Candidate& c = candidates[i];
+			if (state[i] != 0 || (c.mode != LSB_SEQUENTIAL && c.mode != LSB_ENHANCED)) continue;
+			int l = (c.layout == STEGO_LAYOUT_ROWS) ? 1 : 0;
+			if (!collected[l]) {
+				int channels = 0;
+				vector<BmpByteRun> runs;
+				if (bmp.getPixelData() &&
+					layoutRuns(bmp.infoHeader(), bmp.getPixelDataSize(), c.layout, channels, runs)) {
+					collectHeaderPlanes(bmp.getPixelData(), bmp.getPixelDataSize(), channels, runs, planes[l]);
+				}
+				collected[l] = true;
+			}
+
+			// زƵͷʱ(Сͼ)ȡ
+			StegoHeader hdr;
+			size_t bits = sizeof(hdr) * 8;
+			if (lsbDecodePlanes(planes[l], c.mask, (c.mode == LSB_ENHANCED) ? 2 : 1,
+				reinterpret_cast<unsigned char*>(&hdr), bits) != bits) continue;
+			if (!headerAcceptable(bmp.infoHeader(), bmp.getPixelDataSize(), c.mode, c.mask, c.layout, ctx, hdr)) {
+				state[i] = 1;
+				++probed;
+			}
+		}
+	}
+
+	auto probe = [&](size_t i) {
+		++probed;
+		const Candidate& c = candidates[i];
+		state[i] = probeCandidate(bmp, c.mode, c.mask, c.layout, ctx, carriers[i], headers[i]) ? 2 : 1;
+		return state[i] == 2;
+	};
+	auto finish = [&](bool found) {
+		report.probed = probed.load();
+		report.cancelled = cancelled.load();
+		report.winner = found ? static_cast<int>(winner.load()) : -1;
+		report.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+		return found;
+	};
+
+	size_t threads = resolveThreads(ctx);
+	shared_ptr<ThreadPool> pool = (ctx.autoDetect && count > 1) ? acquirePool(threads) : nullptr;
+	if (pool) {
+		pool->parallelFor(count, [&](size_t i) {
+			if (winner.load() < i) { ++cancelled; return; }
+			if (state[i] == 1 || !probe(i)) return;
+			if (!concurrent) { lowerTo(winner, i); return; }
+
+			CancelCheck isCancelled = [&winner, i] { return winner.load() < i; };
+			if (handler(i, carriers[i], headers[i], isCancelled)) {
+				lowerTo(winner, i);
+			}
+			else {
+				state[i] = 1;
+				if (isCancelled()) ++cancelled;
+			}
+		});
+		if (concurrent) return finish(winner.load() != none);
+
+		// ˳ͷЧĺѡwinnerʱʾһЧͷ
+		winner = none;
+		cancelled = 0;
+	}
+
+	CancelCheck never = [] { return false; };
+	for (size_t i = 0; i < count; ++i) {
+		if (state[i] == 0 && !probe(i)) continue;
+		if (state[i] != 2) continue;
+		if (handler(i, carriers[i], headers[i], never)) {
+			winner = i;
+			for (size_t j = i + 1; j < count; ++j) cancelled += (state[j] == 0);
+			return finish(true);
+		}
+		state[i] = 1;
+	}
+	return finish(false);
+}
+
+/**
+ * @brief ȡһѡͷ
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in] mode ѡдģʽ
+ * @param[in] channelMask ѡͨ
+ * @param[in] layout ѡ岼
+ * @param[in] ctx д
+ * @param[out] carrier λɹʱλͷ֮
+ * @param[out] header ͷ
+ * @return ͷЧtrue
+ */
+bool StegoCore::probeCandidate(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+	const StegoContext& ctx, StegoCarrier& carrier, StegoHeader& header) const
+{
+	if (!openCarrierForRead(bmp, mode, channelMask, layout, ctx, carrier)) return false;
+	return carrier.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+		headerAcceptable(bmp.infoHeader(), bmp.getPixelDataSize(), mode, channelMask, layout, ctx, header);
+}
+
+/**
+ * @brief ѡͷǷЧ
+ *
+ * ͷͨħʽ־(ʽ־ȡõĲһ)
+ * ݳȲúѡд(ԭȹ̶100MBޣֹЧͷ³)
+ * @param[in] info Ϣͷ
+ * @param[in] dataSize ݴС(ֽ)
+ * @param[in] mode ѡдģʽ
+ * @param[in] channelMask ѡͨ
+ * @param[in] layout ѡ岼
+ * @param[in] ctx д
+ * @param[in] header ͷ
+ * @return Чtrue
+ */
+bool StegoCore::headerAcceptable(const BmpInfoHeader& info, size_t dataSize, SteganoMode mode, uint16_t channelMask,
+	StegoLayout layout, const StegoContext& ctx, const StegoHeader& header) const
+{
+	if (!headerMatchesLayout(header, layout == STEGO_LAYOUT_ROWS, true)) return false;
+
+	// ֤ݳȺ
+	StegoContext candidate = ctx;
+	candidate.mode = mode;
+	candidate.channelMask = channelMask;
+	candidate.layout = layout;
+	candidate.chunkSize = 0;
+	return header.dataLength != 0 && header.dataLength <= calculateCapacity(info, dataSize, candidate);
+}
+
+/**
+ * @brief ȡLSBģʽλñ
+ *
+ * ͨλñȡͬһͼĶζȡ(ͷݶΡԶĸͨ)
+ * ֻһλñ
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in] password 
+ * @return λñΪաͼΪջڴ治ʱnullptr
+ */
+PermutationCache::PositionsPtr StegoCore::acquirePositions(const BmpImage& bmp, const std::string& password) const
+{
+	if (password.empty() || bmp.getPixelDataSize() == 0) return nullptr;
+	try {
+		return m_permCache.acquire(password, bmp.getPixelDataSize(), bmp.getBitCount());
+	}
+	catch (...) {
+		cerr << "[] ڴʧ: λñ " << bmp.getPixelDataSize() << " " << endl;
+		return nullptr;
+	}
+}
+
+/**
+ * @brief ȡֶβждʹõ̳߳
+ *
+ * ߳Ҳ봦˹߳Ϊthreads-1̳߳״Ҫʱ
+ * ֮߳ʱ滻Ϊ̳߳أʹþ̳߳صĶдãӰ졣
+ *
+ * @param[in] threads ߳(߳)
+ * @return ̳߳أthreads1ʱnullptr
+ */
+std::shared_ptr<ThreadPool> StegoCore::acquirePool(size_t threads) const
+{
+	if (threads <= 1) return nullptr;
+	lock_guard<mutex> lock(m_poolMutex);
+	if (!m_pool || m_pool->size() < threads - 1) {
+		try {
+			m_pool = make_shared<ThreadPool>(threads - 1);
+		}
+		catch (...) {
+			cerr << "[] ̳߳ʧܣΪ̴߳" << endl;
+			return m_pool;
+		}
+	}
+	return m_pool;
+}
+
+/**
+ * @brief ֻʽ򿪺ѡģʽλ
+ *
+ * ģʽλñͨȡԶʱͨ빲ͬһݡ
+ *
+ * @param[in] bmp BMPͼ
+ * @param[in] mode Եдģʽ
+ * @param[in] channelMask Եͨ
+ * @param[in] layout Ե岼
+ * @param[in] ctx д(ʹеں)
+ * @param[out] carrier 򿪵λ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::openCarrierForRead(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask,
+	StegoLayout layout, const StegoContext& ctx, StegoCarrier& carrier) const
+{
+	PermutationCache::PositionsPtr positions;
+	if (mode == LSB_RANDOM) {
+		positions = acquirePositions(bmp, ctx.password);
+		if (!positions) return false;
+	}
+	if (!carrier.open(bmp, mode, channelMask, layout, ctx.password, ctx.kernel, positions)) return false;
+	size_t threads = resolveThreads(ctx);
+	carrier.setParallel(acquirePool(threads), threads);
+	return true;
+}
 
-		// ȷǰλöӦͨ
-		int ch = idx % ((pixelDataSize % 4 == 0) ? 4 : 3);
+/**
+ * @brief дԿдʽλ
+ * @param[in,out] bmp BMPͼ
+ * @param[in] ctx д(ʹmodechannelMasklayout롢ں߳)
+ * @param[out] carrier 򿪵λλλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::openCarrierForWrite(BmpImage& bmp, const StegoContext& ctx, StegoCarrier& carrier) const
+{
+	PermutationCache::PositionsPtr positions;
+	if (ctx.mode == LSB_RANDOM) {
+		positions = acquirePositions(bmp, ctx.password);
+		if (!positions) return false;
+	}
+	StegoLayout layout = usesRowLayout(ctx) ? STEGO_LAYOUT_ROWS : STEGO_LAYOUT_LEGACY;
+	if (!carrier.open(bmp, ctx.mode, ctx.channelMask, layout, ctx.password, ctx.kernel, positions)) return false;
+	size_t threads = resolveThreads(ctx);
+	carrier.setParallel(acquirePool(threads), threads);
+	return true;
+}
+
+/**
+ * @brief дͷ
+ *
+ * ݷֿȡsourceÿڻУֵۼơXORǶ룬
+ * ҪݴСĻͷԿУֵռλд룬
+ * дԭλûдУֵ
+ * ֿУʽλãУֵۼƣд
+ * ͷУֵȡУֵ
+ *
+ * @param[in,out] carrier дλλλ
+ * @param[in,out] header дͷʱУֵ
+ * @param[in] length ݳ
+ * @param[in] blockSize С
+ * @param[in] source ݿԴ
+ * @param[in] ctx д
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCore::writePayload(StegoCarrier& carrier, StegoHeader& header, size_t length, size_t blockSize,
+	const PayloadSource& source, const StegoContext& ctx) const
+{
+	StegoCarrier headerPos = carrier;
+	if (!carrier.write(reinterpret_cast<const char*>(&header), sizeof(header))) return false;
+
+	// ֿУ飺֮ǰݰƫƼ
+	bool chunked = (header.stegoMode & STEGO_FMT_CHUNKED) != 0;
+	size_t chunkSize = ctx.chunkSize;
+	size_t base = 0;
+	vector<uint32_t> crcs;
+	StegoCarrier tablePos;
+	shared_ptr<ThreadPool> pool;
+	if (chunked) {
+		if (chunkSize == 0) return false;
+		base = chunkTableSize(length, chunkSize);
+		try {
+			crcs.assign((length + chunkSize - 1) / chunkSize, 0);
+		}
+		catch (...) {
+			cerr << "[] ڴʧ:  " << base << " ֽ" << endl;
+			return false;
+		}
+		tablePos = carrier;
+		if (!carrier.skip(base)) return false;
+		pool = acquirePool(resolveThreads(ctx));
+	}
+
+	uint32_t crc = 0;
+	for (size_t offset = 0; offset < length; offset += blockSize) {
+		size_t n = min(blockSize, length - offset);
+		char* block = source(offset, n);
+		if (!block) return false;
+		if (chunked) {
+			forEachChunkPiece(offset, n, chunkSize, pool.get(), [&](size_t c, size_t begin, size_t len) {
+				crcs[c] = checksumUpdate(ctx.checksum, crcs[c], block + (begin - offset), len);
+			});
+		}
+		else {
+			crc = checksumUpdate(ctx.checksum, crc, block, n);
+		}
+		xorEncryptBuffer(block, n, ctx.password, base + offset);
+		if (!carrier.write(block, n)) return false;
+	}
+
+	if (chunked) {
+		// ͷУֵǿ
+		vector<char> table(base);
+		StegoChunkTable head;
+		memcpy(head.signature, "CHNK", 4);
+		head.chunkSize = static_cast<uint32_t>(chunkSize);
+		head.dataLength = static_cast<uint32_t>(length);
+		head.chunkCount = static_cast<uint32_t>(crcs.size());
+		memcpy(table.data(), &head, sizeof(head));
+		memcpy(table.data() + sizeof(head), crcs.data(), crcs.size() * sizeof(uint32_t));
+		crc = checksumUpdate(ctx.checksum, 0, table.data(), table.size());
+		xorEncryptBuffer(table.data(), table.size(), ctx.password, 0);
+		if (!tablePos.write(table.data(), table.size())) return false;
+	}
+
+	// дУֵͷ
+	header.crc32Value = crc;
+	return headerPos.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
 
-		// 鵱ǰͨǷ
-		if ((channelMask >> ch) & 0x01) {
-			// ȡԴλ
-			int v = (src[srcByte] >> (7 - srcBit)) & 0x01;
+/**
+ * @brief ȡ֤ܲݲ
+ *
+ * ͷ֮ȡÿܡۼУֵsink
+ * ֿУʽreadChunkedPayload
+ *
+ * @param[in,out] carrier λλͷ֮
+ * @param[in] header Ѷȡдͷ
+ * @param[in] blockSize С
+ * @param[in] buffer ÿĶȡĿ
+ * @param[in] sink ÿܺȥ򣬿Ϊ
+ * @param[in] ctx д
+ * @param[out] damaged ֿУʽУʧܵķΧ׷ӵ˴Ϊ
+ * @param[in] scanAll ֿУʽ𻵺ǷУ
+ * @return ȡɹУֵһ·true
+ */
+bool StegoCore::readPayload(StegoCarrier& carrier, const StegoHeader& header, size_t blockSize,
+	const PayloadSource& buffer, const PayloadSink& sink, const StegoContext& ctx,
+	std::vector<StegoByteRange>* damaged, bool scanAll) const
+{
+	if (header.stegoMode & STEGO_FMT_CHUNKED) {
+		return readChunkedPayload(carrier, header, blockSize, buffer, sink, ctx, damaged, scanAll);
+	}
 
-			// дλ
-			pixelData[idx] = (pixelData[idx] & 0xFE) | v;
+	ChecksumType type = headerChecksum(header);
+	size_t length = header.dataLength;
+	uint32_t crc = 0;
+	for (size_t offset = 0; offset < length; offset += blockSize) {
+		size_t n = min(blockSize, length - offset);
+		char* block = buffer(offset, n);
+		if (!block || !carrier.read(block, n)) return false;
+		xorEncryptBuffer(block, n, ctx.password, offset);
+		crc = checksumUpdate(type, crc, block, n);
+		if (sink && !sink(block, n)) return false;
+	}
+	return crc == header.crc32Value;
+}
 
-			// ¼
-			++srcBit; ++bitsWritten;
-			if (srcBit == 8) { srcBit = 0; ++srcByte; }
+/**
+ * @brief ȡֿ֤ܲУʽݲ
+ *
+ * ȶȡͷУֵ֤ģʽʱڽ֮ǰʧܡ
+ * ֮ȡݣÿڸֿĲֲнܲۼУֵ
+ * ڱڽķֿ˶ԣʱ¼䷶Χֹͣ(scanAllʱ˶ֿ)
+ * еķֿȫ˶ͨŽsink
+ *
+ * @param[in,out] carrier λλͷ֮
+ * @param[in] header Ѷȡдͷ
+ * @param[in] blockSize С
+ * @param[in] buffer ÿĶȡĿ
+ * @param[in] sink ÿܺȥ򣬿Ϊ
+ * @param[in] ctx д
+ * @param[out] damaged УʧܵķΧ׷ӵ˴(ڷΧϲ)Ϊ
+ * @param[in] scanAll 𻵺Ƿ˶ֿ
+ * @return ЧȫֿУֵһ·true
+ */
+bool StegoCore::readChunkedPayload(StegoCarrier& carrier, const StegoHeader& header, size_t blockSize,
+	const PayloadSource& buffer, const PayloadSink& sink, const StegoContext& ctx,
+	std::vector<StegoByteRange>* damaged, bool scanAll) const
+{
+	ChecksumType type = headerChecksum(header);
+	size_t length = header.dataLength;
+
+	StegoChunkTable head;
+	if (!carrier.read(reinterpret_cast<char*>(&head), sizeof(head))) return false;
+	xorEncryptBuffer(reinterpret_cast<char*>(&head), sizeof(head), ctx.password, 0);
+	if (memcmp(head.signature, "CHNK", 4) != 0 || head.chunkSize == 0 || head.dataLength != length ||
+		head.chunkCount != (length + head.chunkSize - 1) / head.chunkSize) {
+		return false;
+	}
+	size_t chunkSize = head.chunkSize;
+	size_t count = head.chunkCount;
+	vector<uint32_t> expected;
+	vector<uint32_t> actual;
+	try {
+		expected.resize(count);
+		actual.assign(count, 0);
+	}
+	catch (...) {
+		cerr << "[] ڴʧ:  " << count << " " << endl;
+		return false;
+	}
+	size_t crcBytes = count * sizeof(uint32_t);
+	if (!carrier.read(reinterpret_cast<char*>(expected.data()), crcBytes)) return false;
+	xorEncryptBuffer(reinterpret_cast<char*>(expected.data()), crcBytes, ctx.password, sizeof(head));
+	uint32_t crc = checksumUpdate(type, 0, &head, sizeof(head));
+	if (checksumUpdate(type, crc, expected.data(), crcBytes) != header.crc32Value) return false;
+
+	size_t base = sizeof(head) + crcBytes;
+	shared_ptr<ThreadPool> pool = acquirePool(resolveThreads(ctx));
+	bool ok = true;
+	for (size_t offset = 0; offset < length; offset += blockSize) {
+		size_t n = min(blockSize, length - offset);
+		char* block = buffer(offset, n);
+		if (!block || !carrier.read(block, n)) return false;
+		forEachChunkPiece(offset, n, chunkSize, pool.get(), [&](size_t c, size_t begin, size_t len) {
+			char* piece = block + (begin - offset);
+			xorEncryptBuffer(piece, len, ctx.password, base + begin);
+			actual[c] = checksumUpdate(type, actual[c], piece, len);
+		});
+
+		// ˶ڱڽķֿ
+		for (size_t c = offset / chunkSize; c < count && min((c + 1) * chunkSize, length) <= offset + n; ++c) {
+			if (actual[c] == expected[c]) continue;
+			size_t begin = c * chunkSize;
+			if (damaged) appendRange(*damaged, begin, min(chunkSize, length - begin));
+			if (!scanAll) return false;
+			ok = false;
 		}
+		if (ok && sink && !sink(block, n)) return false;
 	}
+	return ok;
+}
 
-	// Ƿдλ
-	return bitsWritten == totalBits;
+/**
+ * @brief ֻʽλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::open(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+	const std::string& password, LsbKernel kernel, PermutationCache::PositionsPtr positions)
+{
+	return init(bmp, nullptr, mode, channelMask, layout, password, kernel, move(positions));
+}
+
+/**
+ * @brief Կдʽλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::open(BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+	const std::string& password, LsbKernel kernel, PermutationCache::PositionsPtr positions)
+{
+	unsigned char* writable = bmp.getWritablePixels();
+	return init(bmp, writable, mode, channelMask, layout, password, kernel, move(positions));
 }
 
 /**
- * @brief LSBȡ㷨
+ * @brief ģʽ׼λ״̬
  *
- * ʹдͬαУȷȡλá
+ * ˳/ǿģʽԭвԭԼݴСܷ4²ͨ
+ * гΪ4ֽڱ24λͼҲ4֣ͨ뱣ֲԼдͼ
+ * вֵÿЧֽڶر߽翪ʼֱͨȡͼλ
+ * ֲֶʾΪЧֽڶУԭвֻиݵһΡ
  *
- * @param[in] pixelData ݻ
- * @param[in] pixelDataSize ݴС
- * @param[out] dst Ŀݻ
- * @param[in] numBytes Ҫȡֽ
+ * @param[in] bmp BMPͼ
+ * @param[in] writable дָ룬ֻʱΪ
+ * @param[in] mode дģʽ
  * @param[in] channelMask ͨ
- * @param[in] bitsPerChannel ÿͨʹõλ(ͨΪ1)
- * @param[in] password е
- * @param[in] offsetBits ʼλƫ
+ * @param[in] layout 岼
+ * @param[in] password 
+ * @param[in] kernel ں
+ * @param[in] positions ģʽλñ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::init(const BmpImage& bmp, unsigned char* writable, SteganoMode mode, uint16_t channelMask,
+	StegoLayout layout, const std::string& password, LsbKernel kernel,
+	PermutationCache::PositionsPtr positions)
+{
+	*this = StegoCarrier();
+	m_mode = mode;
+	m_pixels = bmp.getPixelData();
+	m_writable = writable;
+	m_size = bmp.getPixelDataSize();
+	m_channelMask = channelMask;
+	if (m_size == 0 || !m_pixels) return false;
+
+	if (mode == LSB_SEQUENTIAL || mode == LSB_ENHANCED) {
+		LsbPattern pattern;
+		pattern.channelMask = channelMask;
+		pattern.bitsPerChannel = (mode == LSB_ENHANCED) ? 2 : 1;
+		if (layout == STEGO_LAYOUT_ROWS) {
+			BmpPlaneView view = bmp.getPlaneView();
+			if (!view.valid()) return false;
+			pattern.channels = view.channels;
+			m_runs = make_shared<vector<BmpByteRun>>(move(view.runs));
+		}
+		else {
+			// ²ͼͨ
+			pattern.channels = legacyChannels(m_size);
+			m_runs = make_shared<vector<BmpByteRun>>(1, BmpByteRun{ 0, m_size });
+		}
+		m_ops = lsbSelectKernel(kernel, pattern);
+		return true;
+	}
+
+	if (mode == LSB_RANDOM) {
+		if (!positions || positions->size() != m_size) return false;
+		m_positions = move(positions);
+		m_guessChannels = legacyChannels(m_size);
+		return true;
+	}
+
+	if (mode == LSB_RANDOM_LAZY) {
+		// ƽͼѰַĩ
+		BmpPlaneView view = bmp.getPlaneView();
+		if (password.empty() || !view.valid()) return false;
+		m_channels = view.channels;
+		m_width = static_cast<size_t>(view.width);
+		m_rowStride = view.rowStride;
+
+		// ռͨڵֽƫ
+		for (int ch = 0; ch < m_channels; ++ch) {
+			if ((channelMask >> ch) & 0x01) m_chanIdx[m_used++] = ch;
+		}
+		if (m_used == 0) return false;
+
+		// ±ռ䣺Чͨ
+		uint64_t domain = static_cast<uint64_t>(view.pixelCount()) * m_used;
+		if (domain == 0) return false;
+		m_perm = make_shared<FeistelPermutation>(password, domain);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief ӵǰλд
+ * @param[in] src Դ
+ * @param[in] numBytes ֽ
  * @return ɹtrueʧܷfalse
  */
-bool StegoCore::readRandomLSB(const unsigned char* pixelData, size_t pixelDataSize,
-	char* dst, size_t numBytes,
-	uint16_t channelMask, int bitsPerChannel,
-	const std::string& password, size_t offsetBits) const
+bool StegoCarrier::write(const char* src, size_t numBytes)
 {
 	if (numBytes == 0) return true;
-	if (pixelDataSize == 0) return false;
-	if (password.empty()) return false;
+	if (!m_writable) return false;
 
-	// λ
-	vector<size_t> positions(pixelDataSize);
-	iota(positions.begin(), positions.end(), 0);  // 0pixelDataSize-1
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(src);
+	size_t totalBits = numBytes * 8;
+	switch (m_mode) {
+	case LSB_SEQUENTIAL:
+	case LSB_ENHANCED:    return writeRuns(bytes, totalBits);
+	case LSB_RANDOM:      return writeRandom(bytes, totalBits);
+	case LSB_RANDOM_LAZY: return writeLazyRandom(bytes, totalBits);
+	}
+	return false;
+}
 
-	// ʹΪ
-	std::seed_seq seq(password.begin(), password.end());
-	mt19937 rng(seq);
-	shuffle(positions.begin(), positions.end(), rng);  // λ
+/**
+ * @brief ӵǰλöȡ
+ * @param[out] dst Ŀ껺
+ * @param[in] numBytes ֽ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::read(char* dst, size_t numBytes)
+{
+	if (numBytes == 0) return true;
+	if (!m_pixels) return false;
 
-	// ʼ
+	unsigned char* bytes = reinterpret_cast<unsigned char*>(dst);
 	size_t totalBits = numBytes * 8;
+	switch (m_mode) {
+	case LSB_SEQUENTIAL:
+	case LSB_ENHANCED:    return readRuns(bytes, totalBits);
+	case LSB_RANDOM:      return readRandom(bytes, totalBits);
+	case LSB_RANDOM_LAZY: return readLazyRandom(bytes, totalBits);
+	}
+	return false;
+}
+
+/**
+ * @brief ǰλǰnumBytesֽ
+ *
+ * ˳/ǿģʽseekRunsģʽֱû±꣬
+ * ģʽͳλñͨλá
+ *
+ * @param[in] numBytes ֽ
+ * @return ɹtrueʣ岻ʱfalse
+ */
+bool StegoCarrier::skip(size_t numBytes)
+{
+	if (numBytes == 0) return true;
+	if (!m_pixels) return false;
+
+	size_t numBits = numBytes * 8;
+	switch (m_mode) {
+	case LSB_SEQUENTIAL:
+	case LSB_ENHANCED:
+		seekRuns(numBits);
+		return m_run < m_runs->size();
+	case LSB_RANDOM: {
+		const PermutationCache::Positions& positions = *m_positions;
+		for (; numBits > 0 && m_pos < m_size; ++m_pos) {
+			if ((m_channelMask >> (positions[m_pos] % m_guessChannels)) & 0x01) --numBits;
+		}
+		return numBits == 0;
+	}
+	case LSB_RANDOM_LAZY:
+		if (m_pos + numBits > m_perm->domain()) return false;
+		m_pos += numBits;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief ÷ֶβждʹõ̳߳
+ * @param[in] pool ̳߳
+ * @param[in] threads зֵ
+ */
+void StegoCarrier::setParallel(std::shared_ptr<ThreadPool> pool, size_t threads)
+{
+	m_pool = move(pool);
+	m_threads = m_pool ? max<size_t>(threads, 1) : 1;
+}
+
+/**
+ * @brief ˳/ǿģʽд
+ * @param[in] src Դ
+ * @param[in] totalBits Ҫдλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::writeRuns(const unsigned char* src, size_t totalBits)
+{
+	return splitBits(totalBits, [src](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.embedRuns(src, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief ˳/ǿģʽȡ
+ * @param[out] dst Ŀ
+ * @param[in] totalBits Ҫȡλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::readRuns(unsigned char* dst, size_t totalBits)
+{
+	return splitBits(totalBits, [dst](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.extractRuns(dst, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief λзΪ䲢д
+ *
+ * 䳤ȡ8ıӦֽڣģʽ²ͬλʹòֽͬ
+ * (˳/ǿģʽÿֽڳصλ8ģʽλûͬ)˸ɲд
+ * ʼλplanRangesʵʶд޷λʱ˻ص̴߳
+ * ɺλλһĽ뵥߳һ¡
+ *
+ * @param[in] totalBits λ
+ * @param[in] fn 䴦
+ * @return ɹtrue
+ */
+bool StegoCarrier::splitBits(size_t totalBits, const RangeFn& fn)
+{
+	size_t parts = m_pool ? min(m_threads, totalBits / kMinParallelBits) : 1;
+	if (parts < 2) return fn(*this, 0, totalBits);
+
+	size_t step = (totalBits / parts + 7) & ~static_cast<size_t>(7);
+	parts = (totalBits + step - 1) / step;
+
+	vector<StegoCarrier> cursors(parts, *this);
+	if (!planRanges(step, cursors)) return fn(*this, 0, totalBits);
+
+	vector<char> ok(parts, 0);
+	m_pool->parallelFor(parts, [&](size_t i) {
+		size_t first = i * step;
+		ok[i] = fn(cursors[i], first, min(step, totalBits - first));
+	});
+
+	m_run = cursors.back().m_run;
+	m_pos = cursors.back().m_pos;
+	return find(ok.begin(), ok.end(), 0) == ok.end();
+}
+
+/**
+ * @brief ʼλ
+ * @param[in] step λ
+ * @param[in,out] cursors λʱλڵǰλãʱiλڵi*stepλ
+ * @return ɹtrueģʽʣλòԶλʱfalse
+ */
+bool StegoCarrier::planRanges(size_t step, std::vector<StegoCarrier>& cursors) const
+{
+	switch (m_mode) {
+	case LSB_SEQUENTIAL:
+	case LSB_ENHANCED:
+		// ǰһʼλֱ
+		for (size_t i = 1; i < cursors.size(); ++i) {
+			cursors[i].m_run = cursors[i - 1].m_run;
+			cursors[i].m_pos = cursors[i - 1].m_pos;
+			cursors[i].seekRuns(step);
+		}
+		return true;
+	case LSB_RANDOM:
+		return planRandom(step, cursors);
+	case LSB_RANDOM_LAZY:
+		// ÿλռûеһ±
+		for (size_t i = 1; i < cursors.size(); ++i) cursors[i].m_pos = m_pos + i * step;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief λǰnumBitsλȼڶдЩλλ
+ *
+ * ڴֽƫxÿusedֽڣƫx֮ǰֽΪ
+ * (x / channels) * used + popcount(mask & ((1 << (x % channels)) - 1))
+ * αȽʣֽɶλʱֻйء
+ *
+ * @param[in] numBits ǰƵλΪÿͨλ
+ */
+void StegoCarrier::seekRuns(size_t numBits)
+{
+	const LsbPattern& p = m_ops.pattern;
+	size_t channels = static_cast<size_t>(p.channels);
+	int chanIdx[4] = { 0, 0, 0, 0 };
+	size_t used = 0;
+	for (int ch = 0; ch < p.channels && ch < 4; ++ch) {
+		if ((p.channelMask >> ch) & 0x01) chanIdx[used++] = ch;
+	}
+	auto enabledBefore = [&](size_t x) {
+		size_t n = (x / channels) * used;
+		for (size_t ch = 0; ch < x % channels; ++ch) n += (p.channelMask >> ch) & 0x01;
+		return n;
+	};
+
+	const vector<BmpByteRun>& runs = *m_runs;
+	size_t units = numBits / p.bitsPerChannel;
+	while (units > 0 && m_run < runs.size()) {
+		size_t first = enabledBefore(m_pos);
+		size_t avail = enabledBefore(runs[m_run].length) - first;
+		if (units > avail) {
+			units -= avail;
+			++m_run;
+			m_pos = 0;
+			continue;
+		}
+		// λunitsֽڣλΪһֽ
+		size_t last = first + units - 1;
+		m_pos = (last / used) * channels + chanIdx[last % used] + 1;
+		units = 0;
+	}
+}
+
+/**
+ * @brief ˳/ǿģʽдһ
+ *
+ * 洢˳δЧֽڣλѡںɣ
+ * λڶ֮䡢д֮νӡ
+ *
+ * @param[in] src Դ
+ * @param[in] srcBit Դʼλ
+ * @param[in] numBits Ҫдλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::embedRuns(const unsigned char* src, size_t srcBit, size_t numBits)
+{
+	const vector<BmpByteRun>& runs = *m_runs;
+	size_t bitsWritten = 0;
+	while (bitsWritten < numBits && m_run < runs.size()) {
+		const BmpByteRun& run = runs[m_run];
+		bitsWritten += m_ops.embed(m_writable + run.offset, run.length, m_pos,
+			src, srcBit + bitsWritten, numBits - bitsWritten);
+		if (bitsWritten < numBits) { ++m_run; m_pos = 0; }
+	}
+
+	// Ƿдλ
+	return bitsWritten == numBits;
+}
+
+/**
+ * @brief ˳/ǿģʽȡһ
+ * @param[out] dst Ŀ
+ * @param[in] dstBit Ŀʼλ
+ * @param[in] numBits Ҫȡλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::extractRuns(unsigned char* dst, size_t dstBit, size_t numBits)
+{
+	const vector<BmpByteRun>& runs = *m_runs;
 	size_t bitsRead = 0;
-	size_t dstByte = 0;
-	int dstBit = 0;
+	while (bitsRead < numBits && m_run < runs.size()) {
+		const BmpByteRun& run = runs[m_run];
+		bitsRead += m_ops.extract(m_pixels + run.offset, run.length, m_pos,
+			dst, dstBit + bitsRead, numBits - bitsRead);
+		if (bitsRead < numBits) { ++m_run; m_pos = 0; }
+	}
 
-	// Ŀ껺
-	memset(dst, 0, numBytes);
+	// Ƿȡλ
+	return bitsRead == numBits;
+}
+
+/**
+ * @brief ģʽд
+ *
+ * ʹɵαȷдλãǿԡ
+ * λñͨ˺ʹá
+ *
+ * @param[in] src Դ
+ * @param[in] totalBits Ҫдλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::writeRandom(const unsigned char* src, size_t totalBits)
+{
+	return splitBits(totalBits, [src](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.embedRandom(src, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief ģʽȡ
+ *
+ * ʹдͬλñȷȡλá
+ *
+ * @param[out] dst Ŀ
+ * @param[in] totalBits Ҫȡλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::readRandom(unsigned char* dst, size_t totalBits)
+{
+	return splitBits(totalBits, [dst](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.extractRandom(dst, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief ģʽλñеʼ±
+ *
+ * ͨλλñзֲ޷ֱkλ±꣬жλ
+ * 1. ͨλñΧֺͳÿͨλ
+ * 2. ͳƽǰ׺ҵÿڵĲ֣ڸòڲλ
+ *
+ * @param[in] step λ
+ * @param[in,out] cursors λ
+ * @return ɹtrueƷΧڵλòʱfalse
+ */
+bool StegoCarrier::planRandom(size_t step, std::vector<StegoCarrier>& cursors) const
+{
+	const PermutationCache::Positions& positions = *m_positions;
+	size_t channels = static_cast<size_t>(m_guessChannels);
+	size_t enabled = 0;
+	for (size_t ch = 0; ch < channels; ++ch) enabled += (m_channelMask >> ch) & 0x01;
+	if (enabled == 0 || m_pos >= m_size) return false;
+
+	auto selected = [&](size_t i) { return ((m_channelMask >> (positions[i] % channels)) & 0x01) != 0; };
+
+	// һΪneedλƷΧ
+	size_t need = (cursors.size() - 1) * step;
+	size_t span = min(m_size - m_pos, need / enabled * channels + need / 16 + 4096);
+	size_t chunks = cursors.size();
+	size_t chunkSize = (span + chunks - 1) / chunks;
+
+	vector<size_t> before(chunks + 1, 0);
+	m_pool->parallelFor(chunks, [&](size_t c) {
+		size_t begin = m_pos + min(span, c * chunkSize);
+		size_t end = m_pos + min(span, (c + 1) * chunkSize);
+		size_t count = 0;
+		for (size_t i = begin; i < end; ++i) count += selected(i);
+		before[c + 1] = count;
+	});
+	for (size_t c = 0; c < chunks; ++c) before[c + 1] += before[c];
+	if (before[chunks] <= need) return false;
+
+	m_pool->parallelFor(cursors.size() - 1, [&](size_t j) {
+		size_t target = (j + 1) * step;
+		size_t c = static_cast<size_t>(upper_bound(before.begin(), before.end(), target) - before.begin()) - 1;
+		size_t i = m_pos + c * chunkSize;
+		for (size_t k = before[c];; ++i) {
+			if (selected(i) && k++ == target) break;
+		}
+		cursors[j + 1].m_pos = i;
+	});
+	return true;
+}
+
+/**
+ * @brief ģʽдһ
+ * @param[in] src Դ
+ * @param[in] srcBit Դʼλ
+ * @param[in] numBits Ҫдλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::embedRandom(const unsigned char* src, size_t srcBit, size_t numBits)
+{
+	const PermutationCache::Positions& positions = *m_positions;
+	size_t bitsWritten = 0;
+
+	// ӵǰλÿʼλд
+	for (; bitsWritten < numBits && m_pos < m_size; ++m_pos) {
+		size_t idx = positions[m_pos];  // λ
+
+		// 鵱ǰλöӦͨǷ
+		if ((m_channelMask >> (idx % m_guessChannels)) & 0x01) {
+			// ȡԴλд
+			size_t b = srcBit + bitsWritten;
+			int v = (src[b >> 3] >> (7 - (b & 7))) & 0x01;
+			m_writable[idx] = (m_writable[idx] & 0xFE) | v;
+			++bitsWritten;
+		}
+	}
 
-	// ָƫʼλȡ
-	for (size_t i = offsetBits; bitsRead < totalBits && i < pixelDataSize; ++i) {
-		size_t idx = positions[i];  // λ
+	// Ƿдλ
+	return bitsWritten == numBits;
+}
 
-		// ȷǰλöӦͨ
-		int ch = idx % ((pixelDataSize % 4 == 0) ? 4 : 3);
+/**
+ * @brief ģʽȡһ
+ * @param[out] dst Ŀ
+ * @param[in] dstBit ĿʼλΪ8ı
+ * @param[in] numBits Ҫȡλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::extractRandom(unsigned char* dst, size_t dstBit, size_t numBits)
+{
+	const PermutationCache::Positions& positions = *m_positions;
+	size_t bitsRead = 0;
 
-		// 鵱ǰͨǷ
-		if ((channelMask >> ch) & 0x01) {
-			// ȡλ
-			int v = pixelData[idx] & 0x01;
+	// Ŀ껺
+	dst += dstBit >> 3;
+	memset(dst, 0, numBits / 8);
 
-			// ȡλдĿ껺
-			dst[dstByte] |= v << (7 - dstBit);
+	// ӵǰλÿʼλȡ
+	for (; bitsRead < numBits && m_pos < m_size; ++m_pos) {
+		size_t idx = positions[m_pos];  // λ
 
-			// ¼
-			++dstBit; ++bitsRead;
-			if (dstBit == 8) { dstBit = 0; ++dstByte; }
+		// 鵱ǰλöӦͨǷ
+		if ((m_channelMask >> (idx % m_guessChannels)) & 0x01) {
+			dst[bitsRead >> 3] |= (m_pixels[idx] & 0x01) << (7 - (bitsRead & 7));
+			++bitsRead;
 		}
 	}
 
 	// Ƿȡλ
-	return bitsRead == totalBits;
-}
\ No newline at end of file
+	return bitsRead == numBits;
+}
+
+/**
+ * @brief ģʽд
+ *
+ * ֽͨڰ(, ͨ)˳Ϊ±꣬
+ * λеkλд±perm(k)Ӧֽڡ
+ * û㣬λñʱλȣͼС޹ء
+ *
+ * @param[in] src Դ
+ * @param[in] totalBits Ҫдλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::writeLazyRandom(const unsigned char* src, size_t totalBits)
+{
+	if (m_pos + totalBits > m_perm->domain()) return false;
+	return splitBits(totalBits, [src](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.embedLazyRandom(src, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief ģʽȡ
+ *
+ * дʹͬûλȡλá
+ *
+ * @param[out] dst Ŀ
+ * @param[in] totalBits Ҫȡλ
+ * @return ɹtrueʧܷfalse
+ */
+bool StegoCarrier::readLazyRandom(unsigned char* dst, size_t totalBits)
+{
+	if (m_pos + totalBits > m_perm->domain()) return false;
+	return splitBits(totalBits, [dst](StegoCarrier& part, size_t firstBit, size_t numBits) {
+		return part.extractLazyRandom(dst, firstBit, numBits);
+	});
+}
+
+/**
+ * @brief ģʽдһ
+ * @param[in] src Դ
+ * @param[in] srcBit Դʼλ
+ * @param[in] numBits Ҫдλ
+ * @return ɹtrue
+ */
+bool StegoCarrier::embedLazyRandom(const unsigned char* src, size_t srcBit, size_t numBits)
+{
+	const FeistelPermutation& perm = *m_perm;
+	for (size_t b = 0; b < numBits; ++b) {
+		// ±ӳ䵽ֽƫ
+		uint64_t e = perm(m_pos + b);
+		size_t idx = lazyOffset(e);
+
+		size_t s = srcBit + b;
+		int v = (src[s >> 3] >> (7 - (s & 7))) & 0x01;
+		m_writable[idx] = (m_writable[idx] & 0xFE) | v;
+	}
+	m_pos += numBits;
+	return true;
+}
+
+/**
+ * @brief ģʽȡһ
+ * @param[out] dst Ŀ
+ * @param[in] dstBit ĿʼλΪ8ı
+ * @param[in] numBits Ҫȡλ
+ * @return ɹtrue
+ */
+bool StegoCarrier::extractLazyRandom(unsigned char* dst, size_t dstBit, size_t numBits)
+{
+	const FeistelPermutation& perm = *m_perm;
+
+	// Ŀ껺
+	dst += dstBit >> 3;
+	memset(dst, 0, numBits / 8);
+
+	for (size_t b = 0; b < numBits; ++b) {
+		uint64_t e = perm(m_pos + b);
+		size_t idx = lazyOffset(e);
+
+		dst[b >> 3] |= (m_pixels[idx] & 0x01) << (7 - (b & 7));
+	}
+	m_pos += numBits;
+	return true;
+}
@@ -2,8 +2,17 @@
 #define STEGO_CORE_H
 
 #include "BmpImage.h"
+#include "Permutation.h"
+#include "LsbKernels.h"
+#include "Crc32.h"
+#include "ThreadPool.h"
 #include <string>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <mutex>
 #include <cstdint>
 #include <limits>
 
@@ -20,12 +29,66 @@
   * @enum SteganoMode
   * @brief д㷨ģʽö
   *
-  * ֲͬLSBдʵַʽڲͬȫӦó
+  * ֲͬLSBдʵַʽڲͬȫӦó
   */
 enum SteganoMode : uint16_t {
 	LSB_SEQUENTIAL = 0, ///< ˳LSBģʽ(1 bit/ͨ)д󵫰ȫ
 	LSB_RANDOM = 1,     ///< LSBģʽ(1 bit/ͨ)Ҫֲ
-	LSB_ENHANCED = 2    ///< ǿLSBģʽ(2 bit/ͨ)ƽ
+	LSB_ENHANCED = 2,   ///< ǿLSBģʽ(2 bit/ͨ)ƽ
+	LSB_RANDOM_LAZY = 3 ///< LSBģʽ(1 bit/ͨ)Ҫ룬ûλãڴO(1)
+};
+
+/**
+ * @enum StegoLayout
+ * @brief ˳/ǿģʽ岼
+ *
+ * ˳ǿģʽģʽʼʹԭв֡
+ */
+enum StegoLayout : uint16_t {
+	STEGO_LAYOUT_LEGACY = 0, ///< ԭв֣Ϊֽڣ䣬ͨݴС²
+	STEGO_LAYOUT_ROWS = 1    ///< в֣п䣬ͨȡʵλ
+};
+
+/**
+ * @enum StegoFormatFlag
+ * @brief дͷʽ־
+ *
+ * StegoHeader::stegoModeĸֽڣֽΪSteganoMode
+ * ɰ汾дͷֽںΪ0˾ļճȡδ֪־ͷΪЧ
+ */
+enum StegoFormatFlag : uint16_t {
+	STEGO_FMT_MODE_MASK = 0x00FF,  ///< ģʽֶ
+	STEGO_FMT_ROW_LAYOUT = 0x0100, ///< ݰв(STEGO_LAYOUT_ROWS)Ƕ
+	STEGO_FMT_CRC32 = 0x0200,      ///< УֵΪ׼CRC-32(CHECKSUM_CRC32)
+	STEGO_FMT_CRC32C = 0x0400,     ///< УֵΪCRC-32C(CHECKSUM_CRC32C)У־δλʱΪԭвCRC32
+	STEGO_FMT_SHARD = 0x0800,      ///< ΪƬStegoShardHeaderͷΪеһ
+	STEGO_FMT_SEGMENTED = 0x1000,  ///< ΪֶθʽStegoSegmentSuperͷΪֶαλֶ
+	STEGO_FMT_ARCHIVE = 0x2000,    ///< ΪԱStegoArchiveIndexԱͷΪԱ
+	STEGO_FMT_CHUNKED = 0x4000,    ///< ݷֿУ飺StegoChunkTableУֵͷΪݣcrc32ValueΪУֵ
+	STEGO_FMT_CHECKSUM_MASK = STEGO_FMT_CRC32 | STEGO_FMT_CRC32C, ///< У㷨ֶ
+	STEGO_FMT_KNOWN_FLAGS = STEGO_FMT_ROW_LAYOUT | STEGO_FMT_CHECKSUM_MASK | STEGO_FMT_SHARD |
+		STEGO_FMT_SEGMENTED | STEGO_FMT_ARCHIVE | STEGO_FMT_CHUNKED ///< ǰ汾ʶȫ־
+};
+
+/**
+ * @struct StegoDetectReport
+ * @brief ȡʱѡ(ģʽ, ͨ, )ͳϢ
+ */
+struct StegoDetectReport {
+	size_t candidates = 0; ///< ѡ
+	size_t probed = 0;     ///< ʵʶȡͷĺѡ
+	size_t cancelled = 0;  ///< ǰĺѡѳɹ;ĺѡ
+	int    winner = -1;    ///< ܵĺѡ˳(ͳ)еţ-1ʾδҵ
+	double elapsedMs = 0;  ///< ʱ()ݶȡУ
+};
+
+/**
+ * @struct StegoByteRange
+ * @brief еһֽڷΧ[offset, offset+length)
+ */
+struct StegoByteRange {
+	size_t offset = 0; ///< ʼƫ(ֽ)
+	size_t length = 0; ///< (ֽ)
 };
 
 /**
@@ -39,6 +102,61 @@ struct StegoContext {
 	uint16_t    channelMask = 0x01;    ///< ɫͨ(B=0x1,G=0x2,R=0x4)
 	std::string password;              ///< (ģʽݼ)
 	bool        autoDetect = false;    ///< ǷԶдģʽͨ
+	double      detectThreshold = 0.0; ///< Զͳ򿪹(0~1)0ʱ˳/ǿģʽѡͷǶֻ˳򣬲ѡ0ʾ
+	LsbKernel   kernel = LSB_KERNEL_AUTO; ///< ˳/ǿģʽλںˣĬϰCPUԶѡ
+	StegoLayout layout = STEGO_LAYOUT_ROWS; ///< ˳/ǿģʽ岼(ȡʱΪ⵽Ĳ)
+	ChecksumType checksum = CHECKSUM_CRC32; ///< дݵУ㷨(ȡʱΪ⵽㷨)
+	unsigned    threads = 0;           ///< дԶ߳0ʾCPU1ʾ̣߳߳޹
+	uint32_t    chunkSize = 0;         ///< ʱķֿУС(ֽ)0ʾһУֵ(ɰ汾ɶ)
+	StegoDetectReport detect;          ///< ȡʱѡͳ
+	std::vector<StegoByteRange> damaged; ///< ȡʱֿУ鷢ֵĵһ𻵷ΧδʱΪ
+};
+
+/**
+ * @struct CoverCapacity
+ * @brief ֻȡͷõĵļд
+ */
+struct CoverCapacity {
+	static const int kModes = 4; ///< дģʽSteganoModeȡֵ
+	static const int kMasks = 7; ///< ֵͨ-1
+
+	std::string path;            ///< ļ·
+	bool        valid = false;   ///< ͷЧΪ24/32λͼ
+	int         width = 0;       ///< ͼ()
+	int         height = 0;      ///< ͼ߶()
+	int         bitCount = 0;    ///< ÿλ
+	size_t      capacity[kModes][kMasks] = {}; ///< ģʽͨµ(ֽ)Ѽȥ16ֽͷ
+};
+
+/**
+ * @struct FanOutJob
+ * @brief ͬһеһһļ
+ */
+struct FanOutJob {
+	const char* data = nullptr; ///< 
+	size_t      length = 0;     ///< ݳ(ֽ)
+	std::string output;         ///< BMPļ·
+};
+
+/**
+ * @struct ArchiveMember
+ * @brief ԱеһسԱ
+ */
+struct ArchiveMember {
+	std::string name;           ///< ԱƣΨһ1~65535ֽ
+	const char* data = nullptr; ///< Ա
+	size_t      length = 0;     ///< ݳ(ֽ)
+};
+
+/**
+ * @struct StegoMemberInfo
+ * @brief ӳԱĳԱϢ
+ */
+struct StegoMemberInfo {
+	std::string name;   ///< Ա
+	uint32_t    offset; ///< Աݲеƫ(ֽ)
+	uint32_t    length; ///< Ա(ֽ)
+	uint32_t    crc;    ///< ԱݵУֵ
 };
 
 #pragma pack(push, 1)
@@ -52,13 +170,256 @@ struct StegoContext {
 struct StegoHeader {
 	char     signature[4];  ///< ļʶħ"STEG"(0x53 0x54 0x45 0x47)
 	uint32_t dataLength;    ///< дʵʳ(ֽ)ͷ
-	uint32_t crc32Value;    ///< ԭʼݵCRC32Уֵ(֤)
-	uint16_t stegoMode;     ///< ʵʹõSteganoModeöֵ
+	uint32_t crc32Value;    ///< ԭʼݵУֵ(֤)㷨stegoModeеУ־ָ
+	uint16_t stegoMode;     ///< ֽΪʵʹõSteganoModeöֵֽΪStegoFormatFlagʽ־
 	uint16_t channelMask;   ///< ʵʹõͨ
 };
 #pragma pack(pop)
 static_assert(sizeof(StegoHeader) == 16, "StegoHeader СΪ 16 ֽ");
 
+#pragma pack(push, 1)
+/**
+ * @struct StegoShardHeader
+ * @brief Ƭͷ(16ֽ)
+ *
+ * ƬʱλÿͼݲֵĿͷķƬһܲУֵ
+ * ͷdataLengthṹݰ˳ƴӸƬõ
+ */
+struct StegoShardHeader {
+	char     signature[4];  ///< Ƭʶ"SHRD"
+	uint32_t payloadId;     ///< ͬһƬʶ
+	uint32_t totalLength;   ///< ݳ(ֽ)
+	uint16_t index;         ///< Ƭţ0ʼ
+	uint16_t count;         ///< Ƭ
+};
+#pragma pack(pop)
+static_assert(sizeof(StegoShardHeader) == 16, "StegoShardHeader СΪ 16 ֽ");
+
+#pragma pack(push, 1)
+/**
+ * @struct StegoSegmentSuper
+ * @brief ֶθʽ(16ֽ)
+ *
+ * λڷֶݲֵĿͷٸдͷdataLengthΪݲ(Ԥ)ĳȣ
+ * crc32ValueΪṹУֵ׷滻ֶʱͷֲ䡣
+ * Ϊֶαλ(ΪStegoSegmentTablemaxSegmentsStegoSegmentEntry)ֶ
+ * ݲ尴ֽƫƼܡ
+ */
+struct StegoSegmentSuper {
+	char     signature[4];  ///< ֶαʶ"SEGS"
+	uint16_t version;       ///< ʽ汾ǰΪ1
+	uint16_t maxSegments;   ///< ÿֶαλɵķֶ
+	uint32_t regionLength;  ///< ݲֳ(ֽ)ͷdataLengthһ
+	uint32_t reserved;      ///< Ϊ0
+};
+
+/**
+ * @struct StegoSegmentTable
+ * @brief ֶαλͷ(16ֽ)countStegoSegmentEntry
+ *
+ * λУͨҴϴΪǰֶαʱдһλʹ1
+ * джʱòλУʧܣԭֶαȻЧ˷ֶαлԭӵġ
+ */
+struct StegoSegmentTable {
+	char     signature[4];  ///< ֶαʶ"SEGT"
+	uint32_t generation;    ///< ´
+	uint16_t count;         ///< ֶ
+	uint16_t reserved;      ///< Ϊ0
+	uint32_t tableCrc;      ///< ṹ(ֶΰ0)countУֵ
+};
+
+/**
+ * @struct StegoSegmentEntry
+ * @brief ֶα(12ֽ)
+ */
+struct StegoSegmentEntry {
+	uint32_t offset;        ///< ֶݲеƫ(ֽ)
+	uint32_t length;        ///< ֶγ(ֽ)
+	uint32_t crc;           ///< ֶĵУֵ
+};
+#pragma pack(pop)
+static_assert(sizeof(StegoSegmentSuper) == 16, "StegoSegmentSuper СΪ 16 ֽ");
+static_assert(sizeof(StegoSegmentTable) == 16, "StegoSegmentTable СΪ 16 ֽ");
+static_assert(sizeof(StegoSegmentEntry) == 12, "StegoSegmentEntry СΪ 12 ֽ");
+
+#pragma pack(push, 1)
+/**
+ * @struct StegoArchiveIndex
+ * @brief Աͷ(16ֽ)
+ *
+ * λݲֵĿͷcountԱÿΪStegoArchiveEntrynameLengthֽڵƣ
+ * ֮˳ŸԱݡݲͨһܣͷУֵȫݣ
+ * ԱиԵУֵ˿ֻȡ뵥Ա
+ */
+struct StegoArchiveIndex {
+	char     signature[4];  ///< ʶ"ARCH"
+	uint16_t count;         ///< Ա
+	uint16_t reserved;      ///< Ϊ0
+	uint32_t indexLength;   ///< Աֽ
+	uint32_t indexCrc;      ///< ṹ(ֶΰ0)ԱУֵ
+};
+
+/**
+ * @struct StegoArchiveEntry
+ * @brief Ա(16ֽ)nameLengthֽڵ
+ */
+struct StegoArchiveEntry {
+	uint32_t offset;        ///< Աݲеƫ(ֽ)
+	uint32_t length;        ///< Ա(ֽ)
+	uint32_t crc;           ///< ԱݵУֵ
+	uint16_t nameLength;    ///< ֽ
+	uint16_t reserved;      ///< Ϊ0
+};
+#pragma pack(pop)
+static_assert(sizeof(StegoArchiveIndex) == 16, "StegoArchiveIndex СΪ 16 ֽ");
+static_assert(sizeof(StegoArchiveEntry) == 16, "StegoArchiveEntry СΪ 16 ֽ");
+
+#pragma pack(push, 1)
+/**
+ * @struct StegoChunkTable
+ * @brief ֿУĿͷ(16ֽ)
+ *
+ * λڷֿݲֵĿͷchunkCountuint32_tУֵ֮Ϊݱ
+ * һֽƫƼܡͷdataLengthΪݳ()
+ * crc32ValueΪ(ṹУֵ)Уֵģʽʱֻɷ֡
+ */
+struct StegoChunkTable {
+	char     signature[4];  ///< ʶ"CHNK"
+	uint32_t chunkSize;     ///< С(ֽ)һܲ
+	uint32_t dataLength;    ///< ݳ(ֽ)ͷdataLengthͬ
+	uint32_t chunkCount;    ///< 
+};
+#pragma pack(pop)
+static_assert(sizeof(StegoChunkTable) == 16, "StegoChunkTable СΪ 16 ֽ");
+
+/**
+ * @class StegoCarrier
+ * @brief дģʽеλ
+ *
+ * ĳһ(ģʽ, ͨ, )¿õλһλͷռеλ
+ * дɷֶνУÿδϴνһԶдȫͬ
+ * ˵÷ܡУ鲢Ƕ룬ƴͷ+ݻ
+ * ɸƣƷʱλãддͷ
+ *
+ * ̳߳غһνϴĶдᱻзΪλ䣬ʼλòжд뵥߳ͬ
+ * ˳/ǿģʽɸЧֱֽģʽΪû±꣬
+ * ģʽȲͳλñͨλپݴ˶λ
+ */
+class StegoCarrier {
+public:
+	/**
+	 * @brief ֻʽλ
+	 * @param[in] bmp BMPͼλʹڼ䱣Ч
+	 * @param[in] mode дģʽ
+	 * @param[in] channelMask ͨ
+	 * @param[in] layout 岼(˳/ǿģʽ)
+	 * @param[in] password (ģʽûԿ)
+	 * @param[in] kernel ˳/ǿģʽʹõں
+	 * @param[in] positions ģʽλñģʽΪ
+	 * @return ɹtrueģʽͼƥʱfalse
+	 */
+	bool open(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+		const std::string& password, LsbKernel kernel, PermutationCache::PositionsPtr positions);
+
+	/**
+	 * @brief Կдʽλֻͬ汾
+	 * @note ʱȡдָ룬ֻӳͼڴתΪڴ渱
+	 */
+	bool open(BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+		const std::string& password, LsbKernel kernel, PermutationCache::PositionsPtr positions);
+
+	/**
+	 * @brief ӵǰλд
+	 * @param[in] src Դ
+	 * @param[in] numBytes ֽ
+	 * @return ȫд뷵true岻ֻʽʱfalse
+	 */
+	bool write(const char* src, size_t numBytes);
+
+	/**
+	 * @brief ӵǰλöȡ
+	 * @param[out] dst Ŀ껺
+	 * @param[in] numBytes ֽ
+	 * @return ȫȡtrue岻ʱfalse
+	 */
+	bool read(char* dst, size_t numBytes);
+
+	/**
+	 * @brief ǰλǰƣȼڶȡnumBytesֽڶȡ
+	 * @param[in] numBytes ֽ
+	 * @return ʣ㹻ʱtrue
+	 * @note ˳/ǿģʽֱλãģʽͳλñ̳߳ʱͳ
+	 */
+	bool skip(size_t numBytes);
+
+	/**
+	 * @brief ÷ֶβждʹõ̳߳
+	 * @param[in] pool ̳߳أΪʱ̶߳д
+	 * @param[in] threads зֵ(߳)
+	 */
+	void setParallel(std::shared_ptr<ThreadPool> pool, size_t threads);
+
+private:
+	/// 䴦partλ㣬λ[firstBit, firstBit+numBits)
+	typedef std::function<bool(StegoCarrier& part, size_t firstBit, size_t numBits)> RangeFn;
+
+	bool init(const BmpImage& bmp, unsigned char* writable, SteganoMode mode, uint16_t channelMask,
+		StegoLayout layout, const std::string& password, LsbKernel kernel,
+		PermutationCache::PositionsPtr positions);
+	bool writeRuns(const unsigned char* src, size_t totalBits);
+	bool readRuns(unsigned char* dst, size_t totalBits);
+	bool embedRuns(const unsigned char* src, size_t srcBit, size_t numBits);
+	bool extractRuns(unsigned char* dst, size_t dstBit, size_t numBits);
+	void seekRuns(size_t numBits);
+	bool writeRandom(const unsigned char* src, size_t totalBits);
+	bool readRandom(unsigned char* dst, size_t totalBits);
+	bool embedRandom(const unsigned char* src, size_t srcBit, size_t numBits);
+	bool extractRandom(unsigned char* dst, size_t dstBit, size_t numBits);
+	bool planRandom(size_t step, std::vector<StegoCarrier>& cursors) const;
+	bool writeLazyRandom(const unsigned char* src, size_t totalBits);
+	bool readLazyRandom(unsigned char* dst, size_t totalBits);
+	bool embedLazyRandom(const unsigned char* src, size_t srcBit, size_t numBits);
+	bool extractLazyRandom(unsigned char* dst, size_t dstBit, size_t numBits);
+
+	/// ģʽ±ӳ䵽ֽƫ(e/m_usedЧصĵe%m_usedͨ)
+	size_t lazyOffset(uint64_t e) const {
+		size_t pixel = static_cast<size_t>(e / m_used);
+		return pixel / m_width * m_rowStride + pixel % m_width * m_channels + m_chanIdx[e % m_used];
+	}
+	bool splitBits(size_t totalBits, const RangeFn& fn);
+	bool planRanges(size_t step, std::vector<StegoCarrier>& cursors) const;
+
+	SteganoMode    m_mode = LSB_SEQUENTIAL;  ///< дģʽ
+	const unsigned char* m_pixels = nullptr; ///< 
+	unsigned char* m_writable = nullptr;     ///< дݣֻʱΪ
+	size_t         m_size = 0;               ///< ݴС
+	uint16_t       m_channelMask = 0;        ///< ͨ
+
+	// ˳/ǿģʽʹõЧֽڶ(ԭвΪݵһ)
+	LsbKernelOps   m_ops;                    ///< ѡں
+	std::shared_ptr<const std::vector<BmpByteRun>> m_runs; ///< Чֽڶ(Ʒ)
+	size_t         m_run = 0;                ///< ǰ±
+	std::shared_ptr<ThreadPool> m_pool;      ///< ֶβжд̳߳(ģʽͨ)Ϊʱ߳
+	size_t         m_threads = 1;            ///< зֵ
+
+	// ģʽ
+	PermutationCache::PositionsPtr m_positions; ///< λñ
+	int            m_guessChannels = 0;      ///< ݴС²ͨ(ԭʵһ)
+
+	// ģʽ
+	std::shared_ptr<const FeistelPermutation> m_perm; ///< ±û
+	int            m_channels = 0;           ///< ÿֽ
+	size_t         m_width = 0;              ///< ͼ()
+	size_t         m_rowStride = 0;          ///< п(ֽڣ)
+	int            m_chanIdx[4] = { 0, 0, 0, 0 }; ///< ͨڵֽƫ
+	int            m_used = 0;               ///< õͨ
+
+	/// ǰλã˳/ǿģʽΪֽƫƣģʽΪλñ±꣬ģʽΪû±
+	size_t         m_pos = 0;
+
+	static const size_t kMinParallelBits = 256 * 1024; ///< ÿλСȿ
+};
+
 /**
  * @class StegoCore
  * @brief BMPͼLSBд㷨ʵ
@@ -85,6 +446,19 @@ public:
 	 */
 	bool hideData(BmpImage& bmp, const char* data, size_t length, const StegoContext& ctx);
 
+	/**
+	 * @brief ȡݲصBMPͼ
+	 * @param[in,out] bmp ѼصBMPͼ(޸)
+	 * @param[in,out] in ӵǰλöȡlengthֽ
+	 * @param[in] length ݳ(ֽ)
+	 * @param[in] ctx дĲ
+	 * @return ɹtrueʧܷfalse
+	 * @note ݰkStreamChunkSizeֿȡ̨ȡһͬʱǶ뵱ǰ飬
+	 *       ڴռΪСݳ޹أhideDataȫͬ
+	 * @warning ǰʱͼѱ޸
+	 */
+	bool hideStream(BmpImage& bmp, std::istream& in, size_t length, const StegoContext& ctx);
+
 	/**
 	 * @brief BMPͼȡ
 	 * @param[in] bmp ѼصBMPͼ(ֻ)
@@ -93,27 +467,234 @@ public:
 	 * @param[in,out] ctx д(autoDetect=trueʱmodechannelMask)
 	 * @return ɹtrueʧܷfalse
 	 * @exception 쳣׳УԺȷ
-	 * @note ɱ䣬߸ͷ
+	 * @note ɱ䣬߸ͷţֿУڵһ𻵵ķֿ鴦ֹͣ
+	 *       ䷶Χдctx.damaged
 	 * @warning autoDetect=trueʱ޸ctxеmodechannelMaskֵ
 	 */
 	bool extractData(const BmpImage& bmp, char*& outData, size_t& outLength, StegoContext& ctx);
 
-private:
 	/**
-	 * @brief ݵCRC32Уֵ
-	 * @param buffer ݻ
-	 * @param length ݳ(ֽ)
-	 * @return 32λCRCУֵ
+	 * @brief BMPͼȡݲд
+	 * @param[in] bmp ѼصBMPͼ(ֻ)
+	 * @param[in,out] out 
+	 * @param[out] outLength дݳ
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return дУֵһ·true
+	 * @note ݰkStreamChunkSizeֿ룬̨дһͬʱ뵱ǰ飬
+	 *       ڴռΪСݳ޹
+	 * @warning УֵȫдȷfalseʱпЧݣӦ
+	 */
+	bool extractStream(const BmpImage& bmp, std::ostream& out, size_t& outLength, StegoContext& ctx);
+
+	/**
+	 * @brief Удݲȫ𻵵ֽڷΧ
+	 * @param[in] bmp BMPͼ(ֻ)
+	 * @param[out] damaged УʧܵķΧ(extractDataƫƣƫƵڷΧѺϲ)
+	 * @param[out] length ݳ(extractDataĳͬ)
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return ҵͷЧݷtrueǷdamagedǷΪж
+	 * @note ֿУݾȷ飬ֶԱȷֶԱֻжϣ
+	 *       ֿݵĿֶαԱʱΪδҵ
+	 */
+	bool verifyData(const BmpImage& bmp, std::vector<StegoByteRange>& damaged, size_t& length, StegoContext& ctx);
+
+	/**
+	 * @brief ֻȡļͷݿͷжBMPļǷд
+	 * @param[in] filename BMPļ·
+	 * @param[out] header ҵʱΪͷ(ݳȡģʽͨ)
+	 * @param[in,out] ctx д(autoDetect=trueʱȫ˳/ǿģʽѡҵʱͬextractData²)
+	 * @return ҵЧͷtrueδҵļЧfalse
+	 * @note λöȡͷдͷ(ͨ1KB)ͼС޹أ
+	 *       ģʽͷλȡͼλñڼⷶΧڡ
+	 *       ͷЧУֵֻȡʱ֤
+	 */
+	bool probeFile(const std::string& filename, StegoHeader& header, StegoContext& ctx);
+
+	/**
+	 * @brief ϢͷݴСд
+	 * @param[in] info Ϣͷ
+	 * @param[in] dataSize ݴС(ֽ)
+	 * @param[in] ctx дĲ(ʹmodechannelMasklayoutchunkSize)
+	 * @return (ֽ)Ѽȥ16ֽͷֿУĿֵ֧ĸʽ0
+	 */
+	size_t calculateCapacity(const BmpInfoHeader& info, size_t dataSize, const StegoContext& ctx) const;
+
+	/**
+	 * @brief ֻȡBMPļͷģʽͨµд
+	 * @param[in] filename BMPļ·
+	 * @param[out] cover Ϣ
+	 * @param[in] ctx дĲ(˳/ǿģʽʹеlayout)
+	 * @return ͷЧΪ24/32λͼʱtrue
+	 */
+	bool queryCapacity(const std::string& filename, CoverCapacity& cover, const StegoContext& ctx) const;
+
+	/**
+	 * @brief ͳĿ¼ȫBMPļд
+	 * @param[in] directory Ŀ¼·(ݹĿ¼)
+	 * @param[out] covers ļϢ·ֵУЧļvalidΪfalse
+	 * @param[in] ctx дĲ(layoutͬqueryCapacitythreadsΪ߳)
+	 * @return Ŀ¼ɴʱtrue
+	 * @note ÿļֻȡ54ֽͷ
+	 */
+	bool scanCapacities(const std::string& directory, std::vector<CoverCapacity>& covers,
+		const StegoContext& ctx) const;
+
+	/**
+	 * @brief ݷֱصͬһĸвԱ
+	 * @param[in] cover ģ壬޸
+	 * @param[in] jobs ݼļ
+	 * @param[in] ctx дĲãʹͬĲ
+	 * @param[out] succeeded jobsһһӦɹزΪ1
+	 * @return ȫɹtrue
+	 * @note ̳߳ϲִУӳ䷽ʽصÿֻƱ޸ĵҳ
+	 *       (BmpImage::cloneCopyOnWrite)ļֻȡһ
+	 */
+	bool hideFanOut(const BmpImage& cover, const std::vector<FanOutJob>& jobs, const StegoContext& ctx,
+		std::vector<unsigned char>& succeeded);
+
+	/**
+	 * @brief ݷƬصBMPͼ
+	 * @param[in,out] covers ͼ񣬰˳õͼ񽫱޸
+	 * @param[in] data ݵָֻ
+	 * @param[in] length ݳ(ֽ)
+	 * @param[in] ctx дĲãƬʹͬĲ
+	 * @param[out] usedCovers ˷Ƭͼ±꣬Ƭ
+	 * @return ɹtrueȫ֮ͲʱfalseҲ޸κͼ
+	 * @note ÿƬռ16ֽڷƬͷƬ̳߳ϲǶ
+	 */
+	bool hideSharded(std::vector<BmpImage>& covers, const char* data, size_t length, const StegoContext& ctx,
+		std::vector<size_t>& usedCovers);
+
+	/**
+	 * @brief ӶBMPͼȡƬ
+	 * @param[in] images зƬͼ˳⣬ɻвƬͼ
+	 * @param[out] outData ݻָ(delete[])
+	 * @param[out] outLength ݳ
+	 * @param[in,out] ctx д(ͬextractDataΪ0ķƬļ)
+	 * @return ҵһҳһµķƬʱtrue
+	 * @note ͼ̳߳ϲȡֶƬʱȡͼ˳еһЧƬһ
+	 */
+	bool extractSharded(const std::vector<BmpImage>& images, char*& outData, size_t& outLength, StegoContext& ctx);
+
+	/**
+	 * @brief BMPͼ½յķֶ
+	 * @param[in,out] bmp ѼصBMPͼ(޸)
+	 * @param[in] ctx дĲ
+	 * @param[in] maxSegments ֶ(1~65535)
+	 * @param[in] regionLength Ԥݲֳ(ֽ)0ʾʹȫ
+	 * @return ɹtrue
+	 * @note ֻдͷֶαλͷͼԭед֮ʧЧ
+	 */
+	bool createSegmented(BmpImage& bmp, const StegoContext& ctx, size_t maxSegments = kDefaultMaxSegments,
+		size_t regionLength = 0);
+
+	/**
+	 * @brief ڷֶĩβ׷һֶ
+	 * @param[in,out] bmp зֶݵBMPͼ(޸)
+	 * @param[in] data ֶ
+	 * @param[in] length ֶγ(ֽ)
+	 * @param[in,out] ctx д(ͬextractDataΪ⵽Ĳ)
+	 * @param[out] index ·ֶε
+	 * @return ɹtrueûзֶݡֶαпռ䲻ʱfalseҲ޸ͼ
+	 * @note длֶαֻ޸·ֶһֶαλڵֽ
+	 */
+	bool appendSegment(BmpImage& bmp, const char* data, size_t length, StegoContext& ctx, size_t& index);
+
+	/**
+	 * @brief 滻һֶε
+	 * @param[in,out] bmp зֶݵBMPͼ(޸)
+	 * @param[in] index ֶ
+	 * @param[in] data µķֶ
+	 * @param[in] length µķֶγ(ֽ)
+	 * @param[in,out] ctx д(ͬappendSegment)
+	 * @return ɹtrue
+	 * @note длֶα滻ԭӵģʱʧܣԭֶαֲ
+	 */
+	bool replaceSegment(BmpImage& bmp, size_t index, const char* data, size_t length, StegoContext& ctx);
+
+	/**
+	 * @brief ȡǰֶα
+	 * @param[in] bmp BMPͼ(ֻ)
+	 * @param[out] segments ֶελáУֵ
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return ҵֶݷtrueδҵʱfalseҲϢ
+	 */
+	bool listSegments(const BmpImage& bmp, std::vector<StegoSegmentEntry>& segments, StegoContext& ctx);
+
+	/**
+	 * @brief ȡֶΣֻȡֶα÷ֶڵλ
+	 * @param[in] bmp BMPͼ(ֻ)
+	 * @param[in] index ֶ
+	 * @param[out] outData ݻָ(delete[])
+	 * @param[out] outLength ݳ
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return ֶδУֵһ·true
+	 */
+	bool extractSegment(const BmpImage& bmp, size_t index, char*& outData, size_t& outLength, StegoContext& ctx);
+
+	static const size_t kDefaultMaxSegments = 64; ///< ½ֶʱĬϵķֶ
+
+	/**
+	 * @brief ԱΪصBMPͼ
+	 * @param[in,out] bmp ѼصBMPͼ(޸)
+	 * @param[in] members ԱݣΨһ
+	 * @param[in] ctx дĲ
+	 * @return ɹtrue
+	 * @note =16ֽͷ+Ա+ԱݣhideDataķʽǶ룻
+	 *       extractDataݲ
+	 */
+	bool hideArchive(BmpImage& bmp, const std::vector<ArchiveMember>& members, const StegoContext& ctx);
+
+	/**
+	 * @brief ȡĳԱ
+	 * @param[in] bmp BMPͼ(ֻ)
+	 * @param[out] members ԱơλáУֵ˳
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return ҵУͨtrue
+	 * @note ֻȡڵλ
+	 */
+	bool listMembers(const BmpImage& bmp, std::vector<StegoMemberInfo>& members, StegoContext& ctx);
+
+	/**
+	 * @brief ȡеĵԱ
+	 * @param[in] bmp BMPͼ(ֻ)
+	 * @param[in] name Ա
+	 * @param[out] outData ݻָ(delete[])
+	 * @param[out] outLength ݳ
+	 * @param[in,out] ctx д(ͬextractData)
+	 * @return ԱУֵһ·true
+	 * @note ֻȡóԱڵλԱҲУ
+	 */
+	bool extractMember(const BmpImage& bmp, const std::string& name, char*& outData, size_t& outLength,
+		StegoContext& ctx);
+
+	/**
+	 * @brief LSBģʽλñڴ
+	 * @param[in] capacityBytes ڴ(ֽ)0ʾû
+	 * @note ÿλñռ ݴС4 ֽڣ޵λñÿ
+	 */
+	void setPermutationCacheLimit(size_t capacityBytes) { m_permCache.setCapacity(capacityBytes); }
+
+	/**
+	 * @brief ȡλñ/δеͳϢ
+	 * @return ͳϢ
 	 */
-	uint32_t calcCRC32(const char* buffer, size_t length) const;
+	PermutationCacheStats permutationCacheStats() const { return m_permCache.stats(); }
 
+	/**
+	 * @brief λñ
+	 */
+	void clearPermutationCache() { m_permCache.clear(); }
+
+private:
 	/**
 	 * @brief ʹԻXOR/
 	 * @param[in,out] buffer (ԭ޸)
 	 * @param length (ֽ)
 	 * @param password (ʱִв)
+	 * @param offset еʼƫƣֿ鴦ʱ֤Կ
 	 */
-	void xorEncryptBuffer(char* buffer, size_t length, const std::string& password) const;
+	void xorEncryptBuffer(char* buffer, size_t length, const std::string& password, size_t offset = 0) const;
 
 	/**
 	 * @brief BMPͼд
@@ -123,32 +704,83 @@ private:
 	 */
 	size_t calculateCapacity(const BmpImage& bmp, const StegoContext& ctx) const;
 
+	/**
+	 * @brief ӻȡLSBģʽλñ
+	 * @param bmp BMPͼ
+	 * @param password ()
+	 * @return λñʧܷnullptr
+	 */
+	PermutationCache::PositionsPtr acquirePositions(const BmpImage& bmp, const std::string& password) const;
+
+	/**
+	 * @brief ȡֶβждʹõ̳߳
+	 * @param threads ߳(߳)
+	 * @return ̲߳threads-1̳߳أthreads1ʱnullptr
+	 */
+	std::shared_ptr<ThreadPool> acquirePool(size_t threads) const;
+
 	/* Ķдʵַ */
-	bool writeAll(BmpImage& bmp, const StegoHeader& header,
-		const char* data, size_t length, const StegoContext& ctx);
-	bool readHeader(const BmpImage& bmp, StegoHeader& headerOut,
-		SteganoMode modeToTry, uint16_t channelMaskToTry,
-		const std::string& password, bool checkSignature) const;
-	bool readDataSection(const BmpImage& bmp, const StegoHeader& header,
-		char* dataOut, size_t length,
-		SteganoMode modeToTry, uint16_t channelMaskToTry,
-		const std::string& password) const;
-
-	/* ģʽľʵ */
-	bool writeSequentialLSB(unsigned char* pixelData, size_t pixelDataSize,
-		const char* src, size_t numBytes,
-		uint16_t channelMask, int bitsPerChannel) const;
-	bool readSequentialLSB(const unsigned char* pixelData, size_t pixelDataSize,
-		char* dst, size_t numBytes,
-		uint16_t channelMask, int bitsPerChannel) const;
-	bool writeRandomLSB(unsigned char* pixelData, size_t pixelDataSize,
-		const char* src, size_t numBytes,
-		uint16_t channelMask, int bitsPerChannel,
-		const std::string& password, size_t offsetBits = 0) const;
-	bool readRandomLSB(const unsigned char* pixelData, size_t pixelDataSize,
-		char* dst, size_t numBytes,
-		uint16_t channelMask, int bitsPerChannel,
-		const std::string& password, size_t offsetBits = 0) const;
+	bool openCarrierForRead(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask,
+		StegoLayout layout, const StegoContext& ctx, StegoCarrier& carrier) const;
+	bool openCarrierForWrite(BmpImage& bmp, const StegoContext& ctx, StegoCarrier& carrier) const;
+
+	/// ݿ黺ԴضӦ[offset, offset+n)Ŀ޸Ŀ飬ʱģʧܷnullptr
+	typedef std::function<char*(size_t offset, size_t n)> PayloadSource;
+	/// ݿȥ򣺽սܺһݣʧܷfalse
+	typedef std::function<bool(const char* block, size_t n)> PayloadSink;
+	/// ȡѯtrueʾиǰĺѡܣǰѡǰ
+	typedef std::function<bool()> CancelCheck;
+	/// ѡЧͷʱãλͷ֮indexΪѡ˳еţ
+	/// trueʾܸúѡʱͬѡĵÿͬʱ
+	typedef std::function<bool(size_t index, StegoCarrier& carrier, const StegoHeader& header,
+		const CancelCheck& cancelled)> CandidateHandler;
+
+	bool findPayload(const BmpImage& bmp, const StegoContext& ctx, const CandidateHandler& handler,
+		bool concurrent, StegoDetectReport& report);
+	bool probeCandidate(const BmpImage& bmp, SteganoMode mode, uint16_t channelMask, StegoLayout layout,
+		const StegoContext& ctx, StegoCarrier& carrier, StegoHeader& header) const;
+	bool headerAcceptable(const BmpInfoHeader& info, size_t dataSize, SteganoMode mode, uint16_t channelMask,
+		StegoLayout layout, const StegoContext& ctx, const StegoHeader& header) const;
+
+	bool hidePayload(BmpImage& bmp, size_t length, size_t blockSize,
+		const PayloadSource& source, const StegoContext& ctx, uint16_t formatFlags = 0);
+	bool writePayload(StegoCarrier& carrier, StegoHeader& header, size_t length, size_t blockSize,
+		const PayloadSource& source, const StegoContext& ctx) const;
+	bool readPayload(StegoCarrier& carrier, const StegoHeader& header, size_t blockSize,
+		const PayloadSource& buffer, const PayloadSink& sink, const StegoContext& ctx,
+		std::vector<StegoByteRange>* damaged = nullptr, bool scanAll = false) const;
+	bool readChunkedPayload(StegoCarrier& carrier, const StegoHeader& header, size_t blockSize,
+		const PayloadSource& buffer, const PayloadSink& sink, const StegoContext& ctx,
+		std::vector<StegoByteRange>* damaged, bool scanAll) const;
+
+	/* ֶθʽ */
+	struct SegmentState;
+	bool findSegmented(const BmpImage& bmp, StegoContext& ctx, SegmentState& state);
+	bool loadSegments(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+		SegmentState& state) const;
+	bool readSegment(const SegmentState& state, size_t index, char* dst, const StegoContext& ctx) const;
+	bool readAllSegments(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+		const CancelCheck& cancelled, char*& outData, size_t& outLength) const;
+	bool writeRegion(BmpImage& bmp, const StegoCarrier& region, size_t offset, const char* plain, size_t n,
+		const StegoContext& ctx) const;
+	bool commitSegments(BmpImage& bmp, const StegoCarrier& region, SegmentState& state,
+		const std::vector<StegoSegmentEntry>& entries, const StegoContext& ctx) const;
+	bool openSegmentsForWrite(BmpImage& bmp, StegoContext& ctx, SegmentState& state, StegoCarrier& region);
+
+	/* Ա */
+	struct ArchiveState;
+	bool findArchive(const BmpImage& bmp, StegoContext& ctx, ArchiveState& state);
+	bool loadArchiveIndex(const StegoCarrier& region, const StegoHeader& header, const StegoContext& ctx,
+		ArchiveState& state) const;
+	bool readMember(const ArchiveState& state, const StegoMemberInfo& member, char* dst,
+		const StegoContext& ctx) const;
+
+	static const size_t kBlockSize = 64 * 1024;          ///< ֿ/У/ǶĿС(ֽ)
+	static const size_t kStreamChunkSize = 1024 * 1024;  ///< hideStream/extractStreamÿζдĿС(ֽ)
+
+	mutable PermutationCache m_permCache; ///< LSBģʽλñ
+	mutable std::mutex       m_poolMutex; ///< m_poolĴ滻
+	mutable std::shared_ptr<ThreadPool> m_pool; ///< ֶβжд̳߳أ״Ҫʱ
 };
 
 #endif // STEGO_CORE_H
\ No newline at end of file
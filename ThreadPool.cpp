@@ -0,0 +1,134 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <exception>
+
+/**
+ * @file ThreadPool.cpp
+ * @brief ̶С̳߳ʵ
+ * @copyright Copyright 2025, Ϣص6
+ */
+
+using namespace std;
+
+/**
+ * @brief ̳߳
+ * @param[in] threads ߳0ʾӲ߳
+ */
+ThreadPool::ThreadPool(size_t threads)
+{
+	if (threads == 0) threads = hardwareThreads();
+	m_workers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		m_workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+/**
+ * @brief й߳
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	for (thread& t : m_workers) t.join();
+}
+
+/**
+ * @brief ύ
+ * @param[in] task 
+ */
+void ThreadPool::post(std::function<void()> task)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_tasks.push_back(move(task));
+	}
+	m_cv.notify_one();
+}
+
+/**
+ * @brief ߳ѭȡִУΪֹͣʱ˳
+ */
+void ThreadPool::workerLoop()
+{
+	for (;;) {
+		function<void()> task;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+			if (m_tasks.empty()) return;
+			task = move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+/**
+ * @brief ִbody(0)body(count-1)
+ *
+ * ±ԭӼַ߳count-1̹߳ͬȡ
+ * ֻ߳ȴѱȡ±ִϣδʼĸʼʱ±켴˳
+ * ˹״̬shared_ptrУ÷غԱЧ
+ *
+ * @param[in] count ±
+ * @param[in] body 
+ */
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body)
+{
+	if (count == 0) return;
+
+	struct State {
+		atomic<size_t> next{ 0 };
+		size_t done = 0;
+		mutex m;
+		condition_variable cv;
+		exception_ptr error;
+		const function<void(size_t)>* body = nullptr;
+		size_t count = 0;
+	};
+	shared_ptr<State> state = make_shared<State>();
+	state->body = &body;
+	state->count = count;
+
+	auto run = [](const shared_ptr<State>& s) {
+		for (;;) {
+			size_t i = s->next.fetch_add(1);
+			if (i >= s->count) return;
+			exception_ptr error;
+			try {
+				(*s->body)(i);
+			}
+			catch (...) {
+				error = current_exception();
+			}
+			lock_guard<mutex> lock(s->m);
+			if (error && !s->error) s->error = error;
+			if (++s->done == s->count) s->cv.notify_all();
+		}
+	};
+
+	size_t helpers = min(count - 1, m_workers.size());
+	for (size_t i = 0; i < helpers; ++i) {
+		post([state, run] { run(state); });
+	}
+	run(state);
+
+	unique_lock<mutex> lock(state->m);
+	state->cv.wait(lock, [&] { return state->done == state->count; });
+	if (state->error) rethrow_exception(state->error);
+}
+
+/**
+ * @brief ȡӲ߳
+ * @return Ӳ߳Ϊ1
+ */
+size_t ThreadPool::hardwareThreads()
+{
+	unsigned n = thread::hardware_concurrency();
+	return n ? n : 1;
+}
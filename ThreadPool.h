@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+/**
+ * @file ThreadPool.h
+ * @brief ̶С̳߳
+ * @copyright Copyright 2025, Ϣص6
+ *
+ * ˳/ǿģʽķֶβждȳʹá
+ */
+
+ /**
+  * @class ThreadPool
+  * @brief ̶̵߳
+  *
+  * ύ˳ɿйִ߳СparallelForɵ߳빤̹߳ͬȡ±꣬
+  * ʹ߳ȫæ(Ƕ׵parallelFor)Ҳɣ
+  */
+class ThreadPool {
+public:
+	/**
+	 * @brief ̳߳
+	 * @param[in] threads ߳0ʾhardwareThreads()
+	 */
+	explicit ThreadPool(size_t threads = 0);
+
+	/**
+	 * @brief ȴύִϺй߳
+	 */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @brief ȡ߳
+	 * @return ߳
+	 */
+	size_t size() const { return m_workers.size(); }
+
+	/**
+	 * @brief ύ
+	 * @param[in] task 񣬲Ӧ׳쳣
+	 */
+	void post(std::function<void()> task);
+
+	/**
+	 * @brief ִbody(0)body(count-1)ȴȫ
+	 * @param[in] count ±
+	 * @param[in] body ͬ±ڲͬ߳ϲִ
+	 * @note body׳ĵһ쳣ȫ±ڵ߳׳
+	 */
+	void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+	/**
+	 * @brief ȡӲ߳
+	 * @return Ӳ߳޷ȡʱ1
+	 */
+	static size_t hardwareThreads();
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread>          m_workers; ///< ߳
+	std::deque<std::function<void()>> m_tasks;   ///< ִ
+	std::mutex                        m_mutex;
+	std::condition_variable           m_cv;
+	bool                              m_stop = false;
+};
+
+#endif // THREAD_POOL_H
@@ -5,9 +5,12 @@
 #include <limits>
 #include <locale>
 #include <iomanip>
+#include <cstdio>
+#include <chrono>
 
 #include "BmpImage.h"
 #include "StegoCore.h"
+#include "CommandLine.h"
 
 /**
  * @file main.cpp
@@ -47,10 +50,11 @@ static void printMainMenu() {
 	cout << "1. 隐藏数据到 BMP 图像\n";
 	cout << "2. 从 BMP 图像提取数据\n";
 	cout << "3. 配置隐写参数\n";
-	cout << "4. 退出程序\n";
+	cout << "4. 批量统计载体容量\n";
+	cout << "5. 退出程序\n";
 	cout << ConsoleColor::Reset;
 	cout << "──────────────────────────────────────────────────\n";
-	cout << "请输入选项 (1-4): ";
+	cout << "请输入选项 (1-5): ";
 }
 
 /**
@@ -67,6 +71,7 @@ static void printStegoSettings(const StegoContext& ctx) {
 	case LSB_SEQUENTIAL: cout << "顺序 LSB (1 bit)"; break;
 	case LSB_RANDOM:     cout << "随机 LSB (1 bit)"; break;
 	case LSB_ENHANCED:   cout << "增强 LSB (2 bit)"; break;
+	case LSB_RANDOM_LAZY: cout << "惰性随机 LSB (1 bit)"; break;
 	default:             cout << "未知";             break;
 	}
 	cout << ConsoleColor::Reset << "\n";
@@ -132,14 +137,15 @@ static void configureStego(StegoContext& ctx, bool isExtract = false) {
 		cout << "1. 顺序 LSB (1 bit)\n";
 		cout << "2. 随机 LSB (1 bit)\n";
 		cout << "3. 增强 LSB (2 bit)\n";
+		cout << "4. 惰性随机 LSB (1 bit)\n";
 		cout << ConsoleColor::Reset;
 		cout << "──────────────────────────────────────────────────\n";
-		cout << "请选择 (1-3): ";
+		cout << "请选择 (1-4): ";
 
 		int m;
-		while (!(cin >> m) || m < 1 || m > 3) {
+		while (!(cin >> m) || m < 1 || m > 4) {
 			cout << ConsoleColor::Red << "[错误] " << ConsoleColor::Reset
-				<< "输入无效，请输入 1-3: ";
+				<< "输入无效，请输入 1-4: ";
 			cin.clear();
 			cin.ignore(numeric_limits<streamsize>::max(), '\n');
 		}
@@ -238,6 +244,27 @@ static void showInfo(const string& message) {
 		<< message << endl;
 }
 
+/**
+ * @brief 打印各模式与通道掩码下的容量表
+ * @param capacity 容量(字节)，按[模式][通道掩码-1]索引
+ */
+static void printCapacityTable(const size_t capacity[CoverCapacity::kModes][CoverCapacity::kMasks]) {
+	// 名称按显示宽度补齐到4个汉字
+	static const char* const modeNames[CoverCapacity::kModes] = { "顺序    ", "随机    ", "增强    ", "惰性随机" };
+	cout << "  模式      ";
+	for (int k = 0; k < CoverCapacity::kMasks; ++k) {
+		cout << setw(12) << ("0x0" + to_string(k + 1));
+	}
+	cout << "\n";
+	for (int m = 0; m < CoverCapacity::kModes; ++m) {
+		cout << "  " << modeNames[m] << "  ";
+		for (int k = 0; k < CoverCapacity::kMasks; ++k) {
+			cout << setw(12) << capacity[m][k];
+		}
+		cout << "\n";
+	}
+}
+
 /**
  * @brief 显示流程标题
  * @param title 流程标题
@@ -247,11 +274,14 @@ static void showProcessTitle(const string& title) {
 	cout << "\n===== " << title << " =====\n" << ConsoleColor::Reset;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 	// 设置本地化以支持中文
 	try { setlocale(LC_ALL, ""); }
 	catch (...) {}
 
+	// 带参数启动时执行子命令，不进入交互式菜单
+	if (argc > 1) return runCommandLine(argc, argv);
+
 	printTitle();
 
 	StegoContext ctx;
@@ -261,15 +291,15 @@ int main() {
 		printMainMenu();
 
 		int choice;
-		while (!(cin >> choice) || choice < 1 || choice > 4) {
+		while (!(cin >> choice) || choice < 1 || choice > 5) {
 			cout << ConsoleColor::Red << "[错误] " << ConsoleColor::Reset
-				<< "输入无效，请输入 1-4: ";
+				<< "输入无效，请输入 1-5: ";
 			cin.clear();
 			cin.ignore(numeric_limits<streamsize>::max(), '\n');
 		}
 		cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-		if (choice == 4) {
+		if (choice == 5) {
 			cout << ConsoleColor::Green << "\n[提示] " << ConsoleColor::Reset
 				<< "感谢使用，程序已安全退出\n";
 			break;
@@ -290,7 +320,7 @@ int main() {
 			BmpImage bmp;
 
 			showProgress("加载 BMP 文件");
-			if (!bmp.load(bmpPath)) {
+			if (!bmp.load(bmpPath, BMP_MAP_PRIVATE)) {
 				showError("加载A BMP 文件失败");
 				continue;
 			}
@@ -312,12 +342,11 @@ int main() {
 
 			showInfo("待隐藏文件大小: " + to_string(sz) + " 字节");
 			fin.seekg(0, ios::beg);
-			vector<char> buffer(sz);
-			fin.read(buffer.data(), sz);
-			fin.close();
 
 			showProgress("正在执行数据隐藏");
-			if (core.hideData(bmp, buffer.data(), buffer.size(), ctx)) {
+			bool hidden = core.hideStream(bmp, fin, static_cast<size_t>(sz), ctx);
+			fin.close();
+			if (hidden) {
 				string outBmp = getFilePath("请输入输出 BMP 文件路径: ");
 
 				showProgress("保存隐写后的 BMP 文件");
@@ -330,6 +359,40 @@ int main() {
 				showError("数据隐藏失败，可能是图像容量不足或参数设置不当");
 			}
 		}
+		else if (choice == 4) {
+			// 批量容量统计流程：只读取各文件头部
+			showProcessTitle("批量统计载体容量");
+			string dirPath = getFilePath("请输入载体 BMP 所在目录: ");
+
+			showProgress("正在读取各文件头部");
+			auto start = chrono::steady_clock::now();
+			vector<CoverCapacity> covers;
+			if (!core.scanCapacities(dirPath, covers, ctx)) {
+				showError("无法打开目录: " + dirPath);
+			}
+			else {
+				double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+				size_t total[CoverCapacity::kModes][CoverCapacity::kMasks] = {};
+				size_t valid = 0;
+				for (const CoverCapacity& cover : covers) {
+					if (!cover.valid) {
+						cout << ConsoleColor::Red << cover.path << " (无效或不支持的格式)" << ConsoleColor::Reset << "\n";
+						continue;
+					}
+					++valid;
+					cout << ConsoleColor::Cyan << cover.path << ConsoleColor::Reset << " (" << cover.width << "x"
+						<< cover.height << ", " << cover.bitCount << " 位)\n";
+					printCapacityTable(cover.capacity);
+					for (int m = 0; m < CoverCapacity::kModes; ++m) {
+						for (int k = 0; k < CoverCapacity::kMasks; ++k) total[m][k] += cover.capacity[m][k];
+					}
+				}
+				cout << ConsoleColor::Yellow << "合计 (" << valid << "/" << covers.size() << " 个有效文件，字节)"
+					<< ConsoleColor::Reset << "\n";
+				printCapacityTable(total);
+				showInfo("统计用时: " + to_string(static_cast<long long>(ms)) + " ms");
+			}
+		}
 		else if (choice == 2) {
 			// 提取流程
 			showProcessTitle("数据提取流程");
@@ -339,19 +402,28 @@ int main() {
 			BmpImage bmp;
 
 			showProgress("加载 BMP 文件");
-			if (!bmp.load(bmpPath)) {
+			if (!bmp.load(bmpPath, BMP_MAP_READONLY)) {
 				showError("加载 BMP 文件失败");
 				continue;
 			}
 			showInfo("BMP 图像尺寸: " + to_string(bmp.getWidth()) + "x" + to_string(bmp.getHeight()));
 
+			string savePath = getFilePath("请输入提取数据的保存路径: ");
+			ofstream fout(savePath, ios::binary);
+			if (!fout.is_open()) {
+				showError("无法创建输出文件: " + savePath);
+				continue;
+			}
+
 			showProgress("正在提取隐藏数据");
-			char* outBuf = nullptr;
 			size_t outLen = 0;
+			bool extracted = core.extractStream(bmp, fout, outLen, ctx);
+			fout.close();
 
-			if (!core.extractData(bmp, outBuf, outLen, ctx)) {
+			if (!extracted) {
+				// 未通过校验的输出不保留
+				remove(savePath.c_str());
 				showInfo("提取失败或未检测到隐藏数据");
-				delete[] outBuf;
 			}
 			else {
 				showSuccess("提取到 " + to_string(outLen) + " 字节隐藏数据");
@@ -361,24 +433,21 @@ int main() {
 				case LSB_SEQUENTIAL: cout << "顺序 LSB"; break;
 				case LSB_RANDOM:     cout << "随机 LSB"; break;
 				case LSB_ENHANCED:   cout << "增强 LSB"; break;
+				case LSB_RANDOM_LAZY: cout << "惰性随机 LSB"; break;
 				}
 				cout << ConsoleColor::Reset << "\n";
 
 				cout << "检测到通道掩码: 0x" << hex << ctx.channelMask << dec << "\n";
-
-				string savePath = getFilePath("请输入提取数据的保存路径: ");
-
-				showProgress("保存提取的数据");
-				ofstream fout(savePath, ios::binary);
-				if (fout.is_open()) {
-					fout.write(outBuf, outLen);
-					fout.close();
-					showSuccess("隐藏数据已保存到: " + savePath);
+				if (ctx.mode == LSB_SEQUENTIAL || ctx.mode == LSB_ENHANCED) {
+					cout << "检测到载体布局: "
+						<< (ctx.layout == STEGO_LAYOUT_ROWS ? "行布局(跳过行填充)" : "原有布局") << "\n";
 				}
-				else {
-					showError("无法创建输出文件: " + savePath);
+				cout << "校验算法: " << checksumName(ctx.checksum) << "\n";
+				if (ctx.autoDetect) {
+					cout << "检测用时: " << fixed << setprecision(1) << ctx.detect.elapsedMs << " ms"
+						<< defaultfloat << " (读取 " << ctx.detect.probed << "/" << ctx.detect.candidates << " 个候选组合的头部)\n";
 				}
-				delete[] outBuf;
+				showSuccess("隐藏数据已保存到: " + savePath);
 			}
 		}
 